@@ -1,12 +1,50 @@
 #include "bdd.h"
 #include "fdd.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "SEGNode.h"
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <cassert>
+#include <climits>
 
 using namespace std;
 
+// Reserve address space for the BDD node table up front, so the table grows
+// in place instead of being copied by realloc
+static llvm::cl::opt<unsigned> NodeReserve("fsaa-node-reserve",
+	llvm::cl::desc("Number of BDD nodes to reserve with mmap (0 = grow the node table with realloc)"),
+	llvm::cl::init(0));
+
+// Give the relational product and restrict caches a fixed size of their own,
+// so the hot operations of the solver do not evict each other's results
+static llvm::cl::opt<unsigned> RelprodCacheSize("fsaa-relprod-cache",
+	llvm::cl::desc("Number of entries in the BDD relprod cache (0 = share the default size)"),
+	llvm::cl::init(0));
+static llvm::cl::opt<unsigned> RestrictCacheSize("fsaa-restrict-cache",
+	llvm::cl::desc("Number of entries in the BDD restrict cache (0 = share the default size)"),
+	llvm::cl::init(0));
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-bdd"
+STATISTIC(ApplyCacheHits,     "Number of BDD apply cache hits");
+STATISTIC(ApplyCacheMisses,   "Number of BDD apply cache misses");
+STATISTIC(ApplyCacheEvicts,   "Number of BDD apply cache evictions");
+STATISTIC(QuantCacheHits,     "Number of BDD quantification cache hits");
+STATISTIC(QuantCacheMisses,   "Number of BDD quantification cache misses");
+STATISTIC(QuantCacheEvicts,   "Number of BDD quantification cache evictions");
+STATISTIC(RelprodCacheHits,   "Number of BDD relprod cache hits");
+STATISTIC(RelprodCacheMisses, "Number of BDD relprod cache misses");
+STATISTIC(RelprodCacheEvicts, "Number of BDD relprod cache evictions");
+STATISTIC(ReplaceCacheHits,   "Number of BDD replace cache hits");
+STATISTIC(ReplaceCacheMisses, "Number of BDD replace cache misses");
+STATISTIC(ReplaceCacheEvicts, "Number of BDD replace cache evictions");
+STATISTIC(RestrictCacheHits,  "Number of BDD restrict cache hits");
+STATISTIC(RestrictCacheMisses,"Number of BDD restrict cache misses");
+STATISTIC(RestrictCacheEvicts,"Number of BDD restrict cache evictions");
+
 #define bdd_sat(b)   ((b) != bdd_false())
 
 // Global to track size of POINTSTO bdd
@@ -19,6 +57,15 @@ void pointsToInit(unsigned int nodes, unsigned int cachesize, unsigned int domai
 	int domain[2];
 	// initialize bdd library
 	assert(!bdd_isrunning());
+	// bdd_setnodereserve takes an int, and its error handler would exit
+	if (NodeReserve > INT_MAX) {
+		llvm::dbgs() << "-fsaa-node-reserve " << NodeReserve << " is larger than "
+			<< INT_MAX << " nodes, growing the node table with realloc\n";
+		bdd_setnodereserve(0);
+	} else {
+		errc = bdd_setnodereserve(NodeReserve);
+		if (errc < 0) llvm::dbgs() << bdd_errstring(errc) << "\n";
+	}
 	errc = bdd_init(nodes,cachesize);
 	if (errc < 0) llvm::dbgs() << bdd_errstring(errc) << "\n";
 	assert(bdd_isrunning());
@@ -32,9 +79,30 @@ void pointsToInit(unsigned int nodes, unsigned int cachesize, unsigned int domai
 	RPAIR = bdd_newpair();
 	assert(fdd_setpair(LPAIR,1,0) >= 0);
 	assert(fdd_setpair(RPAIR,0,1) >= 0);
+	// split off the caches that were given a size of their own
+	if (RelprodCacheSize) bdd_setopcachesize(BDD_CACHE_APPEX,RelprodCacheSize);
+	if (RestrictCacheSize) bdd_setopcachesize(BDD_CACHE_RESTRICT,RestrictCacheSize);
+}
+
+static void readCacheStats(int cache, llvm::Statistic &hits, llvm::Statistic &misses, llvm::Statistic &evicts) {
+	bddOpCacheStat stat;
+	if (bdd_opcachestats(cache,&stat) < 0) return;
+	hits = stat.hits;
+	misses = stat.misses;
+	evicts = stat.evictions;
+}
+
+void pointsToStats() {
+	// the library counts from bdd_init on, so just copy the totals over
+	readCacheStats(BDD_CACHE_APPLY,ApplyCacheHits,ApplyCacheMisses,ApplyCacheEvicts);
+	readCacheStats(BDD_CACHE_QUANT,QuantCacheHits,QuantCacheMisses,QuantCacheEvicts);
+	readCacheStats(BDD_CACHE_APPEX,RelprodCacheHits,RelprodCacheMisses,RelprodCacheEvicts);
+	readCacheStats(BDD_CACHE_REPLACE,ReplaceCacheHits,ReplaceCacheMisses,ReplaceCacheEvicts);
+	readCacheStats(BDD_CACHE_RESTRICT,RestrictCacheHits,RestrictCacheMisses,RestrictCacheEvicts);
 }
 
 void pointsToFinalize() {
+	pointsToStats();
 	bdd_freepair(LPAIR);
 	bdd_freepair(RPAIR);
 	bdd_done();
@@ -45,6 +113,79 @@ bool pointsTo(bdd rel, unsigned int v1, unsigned int v2) {
 	return bdd_sat(rel & fdd_ithvar(0,v1) & fdd_ithvar(1,v2));
 }
 
+// state for bddDomainValues/bddForEachPair, since allsat handlers take no user data
+static std::vector<unsigned int> *allsatValues = NULL;
+static bddPairVisitor allsatVisitor = NULL;
+static void *allsatVisitorData = NULL;
+static int *allsatVars = NULL;
+static int allsatVarNum = 0;
+
+// the values of one domain in a (partial) assignment, expanding don't cares
+static void expandDomain(char *varset, int *vars, int num, std::vector<unsigned int> &values) {
+	unsigned int base = 0;
+	std::vector<unsigned int> free;
+	// the first variable of a domain is its least significant bit
+	for (int i = 0; i < num; i++) {
+		char v = varset[vars[i]];
+		if (v < 0) free.push_back(1u << i);
+		else if (v) base |= 1u << i;
+	}
+	for (unsigned int m = 0; m < (1u << free.size()); m++) {
+		unsigned int val = base;
+		for (unsigned int j = 0; j < free.size(); j++)
+			if (m & (1u << j)) val |= free[j];
+		if (val < POINTSTO_MAX) values.push_back(val);
+	}
+}
+
+static void allsatHandler(char *varset, int size) {
+	expandDomain(varset,allsatVars,allsatVarNum,*allsatValues);
+}
+
+static void allsatPairHandler(char *varset, int size) {
+	std::vector<unsigned int> from, to;
+	expandDomain(varset,fdd_vars(0),fdd_varnum(0),from);
+	expandDomain(varset,fdd_vars(1),fdd_varnum(1),to);
+	for (unsigned int i = 0; i < from.size(); i++)
+		for (unsigned int j = 0; j < to.size(); j++)
+			allsatVisitor(from[i],to[j],allsatVisitorData);
+}
+
+void bddDomainValues(bdd b, int domain, std::vector<unsigned int> &values) {
+	// quantify the other domain out, so every value is visited once
+	bdd other = fdd_ithset(1-domain);
+	allsatValues = &values;
+	allsatVars = fdd_vars(domain);
+	allsatVarNum = fdd_varnum(domain);
+	bdd_allsat(bdd_exist(b,other),allsatHandler);
+	allsatValues = NULL;
+	std::sort(values.begin(),values.end());
+}
+
+void bddForEachPair(bdd b, bddPairVisitor visit, void *data) {
+	assert(allsatVisitor == NULL && "bddForEachPair does not nest");
+	allsatVisitor = visit;
+	allsatVisitorData = data;
+	bdd_allsat(b,allsatPairHandler);
+	allsatVisitor = NULL;
+	allsatVisitorData = NULL;
+}
+
+static void collectPair(unsigned int from, unsigned int to, void *data) {
+	((std::vector<std::pair<unsigned int,unsigned int> >*)data)->push_back(std::make_pair(from,to));
+}
+
+void bddRelationPairs(bdd b, std::vector<std::pair<unsigned int,unsigned int> > &pairs) {
+	bddForEachPair(b,collectPair,&pairs);
+	std::sort(pairs.begin(),pairs.end());
+}
+
+double bddDomainCount(bdd b, int domain) {
+	// values past the end of the domain are not locations
+	bdd values = bdd_exist(b,fdd_ithset(1-domain)) & fdd_domain(domain);
+	return bdd_satcountset(values,fdd_ithset(domain));
+}
+
 // print out a single points-to mapping from Value named i to Valued named j
 void printMapping(map<unsigned int,string*> *lt, int i, int j) {
 	string *s1,*s2;
@@ -61,24 +202,19 @@ void printMapping(map<unsigned int,string*> *lt, int i, int j) {
 	else llvm::dbgs() << j << "\n";
 }
 
-// print out a whole BDD; note that this will be very slow for large BDDs
+// print out a whole BDD; the cost follows the number of pairs, not max
 void printBDD(unsigned int max, map<unsigned int,string*> *lt, bdd b) {
-	unsigned int i, j;
+	std::vector<std::pair<unsigned int,unsigned int> > pairs;
+	unsigned int everywhere = max;
 	bool empty = true;
-	for (i=0;i<max;++i) {
-		// if variable points everywhere, just print points to everything
-		if (bdd_sat(b & fdd_ithvar(0,i) & fdd_ithvar(1,0))) {
-			empty = false;
-			printMapping(lt,i,0);
-			continue;
-		}
-		// otherwise, find out where it actually points
-		for (j=1;j<max;++j) {
-			if (bdd_sat(b & fdd_ithvar(0,i) & fdd_ithvar(1,j))) {
-				empty = false;
-				printMapping(lt,i,j);
-			}
-		}
+	bddRelationPairs(b,pairs);
+	for (unsigned int k = 0; k < pairs.size(); k++) {
+		unsigned int i = pairs[k].first, j = pairs[k].second;
+		if (i >= max || j >= max || i == everywhere) continue;
+		empty = false;
+		printMapping(lt,i,j);
+		// pairs are sorted, so (i,0) comes first: pointing everywhere says it all
+		if (j == 0) everywhere = i;
 	}
 	// if set is is empty, print empty
 	if (empty) llvm::dbgs() << "EMPTY\n";
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "bdd.h"
 #include "fdd.h"
 
@@ -15,11 +16,27 @@
 // Library initialization and finalization
 void pointsToInit(unsigned int nodes, unsigned int cachesize, unsigned int domainsize);
 void pointsToFinalize();
+// Copy the BDD operator cache counters into the pass statistics
+void pointsToStats();
 
 // Helper functions
 bool pointsTo(bdd b, unsigned int v1, unsigned int v2);
 void printBDD(unsigned int max, bdd b);
+// Print the pairs of relation b below max (sorted, and only "i -> 0" for an
+// i that points everywhere) in a single pass over its satisfying assignments
 void printBDD(unsigned int max, std::map<unsigned int,std::string*> *lt, bdd b);
+// Collect the values domain takes in b, in increasing order; visits only
+// the satisfying assignments, so the cost follows the size of the set
+void bddDomainValues(bdd b, int domain, std::vector<unsigned int> &values);
+// Collect the (domain 0, domain 1) pairs of relation b, sorted, in a single
+// pass over its satisfying assignments
+void bddRelationPairs(bdd b, std::vector<std::pair<unsigned int,unsigned int> > &pairs);
+// Call visit on each (domain 0, domain 1) pair of relation b, in the order
+// the satisfying assignments come in; visit must not use bdd_allsat itself
+typedef void (*bddPairVisitor)(unsigned int from, unsigned int to, void *data);
+void bddForEachPair(bdd b, bddPairVisitor visit, void *data);
+// Count the values domain takes in b, without enumerating them
+double bddDomainCount(bdd b, int domain);
 
 // globals that BDD library macros use
 extern unsigned int POINTSTO_MAX;
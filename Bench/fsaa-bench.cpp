@@ -0,0 +1,162 @@
+//===- fsaa-bench.cpp - Benchmark driver for the fs-aa solver --------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs the whole analysis over each .ll/.bc file several times, after some
+// warm-up runs, and prints the median and 95th percentile of every phase,
+// the peak BDD node counts and the worklist iterations, one line per file
+// and metric, so two reports can be diffed. The pass is loaded as a plugin:
+//
+//   fsaa-bench -load=FlowSensitiveAliasAnalysis.so -runs=10 -warmup=2 ../test/*.ll
+//
+//===----------------------------------------------------------------------===//
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/PassManager.h"
+#include "llvm/PassRegistry.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/PluginLoader.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Target/TargetLibraryInfo.h"
+#include "../FSAAnalysis.h"
+#include <algorithm>
+#include <map>
+
+using namespace llvm;
+
+static cl::list<std::string> InputFiles(cl::Positional, cl::OneOrMore,
+	cl::desc("<.ll or .bc files>"));
+
+static cl::opt<unsigned> Runs("runs",
+	cl::desc("Measured runs of the analysis per file"), cl::init(5));
+
+static cl::opt<unsigned> Warmup("warmup",
+	cl::desc("Unmeasured runs before the measured ones"), cl::init(1));
+
+static cl::opt<std::string> OutputFile("o",
+	cl::desc("Write the report to this file"), cl::value_desc("filename"), cl::init("-"));
+
+/// Samples - the values of each metric over the measured runs of one file,
+/// with the metrics in the order they first appeared
+struct Samples {
+	std::vector<std::string> Order;
+	std::map<std::string,std::vector<double> > Values;
+
+	void add(const std::string &metric, double v) {
+		std::vector<double> &vs = Values[metric];
+		if (vs.empty()) Order.push_back(metric);
+		vs.push_back(v);
+	}
+};
+
+// the median of vs (sorts vs)
+static double median(std::vector<double> &vs) {
+	unsigned n = vs.size();
+	std::sort(vs.begin(),vs.end());
+	return n % 2 ? vs[n/2] : (vs[n/2-1] + vs[n/2]) / 2;
+}
+
+// the 95th percentile of sorted vs, by nearest rank
+static double p95(const std::vector<double> &vs) {
+	unsigned rank = (vs.size() * 95 + 99) / 100;
+	return vs[rank ? rank-1 : 0];
+}
+
+// run the analysis on M once, add its costs to s unless this is a warm-up
+static void runOnce(const PassInfo *PI, Module &M, Samples *s) {
+	PassManager PM;
+	FlowSensitiveAliasAnalysis *FSAA;
+	TimeRecord t;
+	Pass *P = PI->createPass();
+	double bddNodes = 0, bddAlloc = 0;
+	PM.add(new TargetLibraryInfo(Triple(M.getTargetTriple())));
+	// fs-aa is a ModulePass first, so this is a plain downcast
+	FSAA = static_cast<FlowSensitiveAliasAnalysis*>(static_cast<ModulePass*>(P));
+	FSAA->recordPhases(true);
+	PM.add(P);
+	t -= TimeRecord::getCurrentTime(true);
+	PM.run(M);
+	t += TimeRecord::getCurrentTime(false);
+	if (s == NULL) return;
+	s->add("total.wall",t.getWallTime() * 1000);
+	const PhaseRecorder &phases = FSAA->getPhases();
+	for (unsigned i = 0; i < phases.size(); i++) {
+		const PhaseRecorder::Phase &p = phases.phase(i);
+		std::string name = p.Name;
+		if (p.Round >= 0) name += "." + utostr(p.Round);
+		s->add(name + ".wall",p.Wall * 1000);
+		bddNodes = std::max(bddNodes,(double)p.BDDPeakNodes);
+		bddAlloc = std::max(bddAlloc,(double)p.BDDAlloc);
+	}
+	s->add("bdd.peak_nodes",bddNodes);
+	s->add("bdd.peak_allocated",bddAlloc);
+	s->add("worklist.iterations",FSAA->getNodeVisits());
+}
+
+int main(int argc, char **argv) {
+	sys::PrintStackTraceOnErrorSignal();
+	PrettyStackTraceProgram X(argc, argv);
+	llvm_shutdown_obj Y;
+	LLVMContext &Context = getGlobalContext();
+	PassRegistry &Registry = *PassRegistry::getPassRegistry();
+	std::string error;
+	initializeCore(Registry);
+	initializeAnalysis(Registry);
+	initializeIPA(Registry);
+	initializeTarget(Registry);
+	cl::ParseCommandLineOptions(argc, argv, "fs-aa benchmark driver\n");
+
+	const PassInfo *PI = Registry.getPassInfo("fs-aa");
+	if (PI == NULL) {
+		errs() << argv[0] << ": fs-aa is not registered, load it with -load\n";
+		return 1;
+	}
+	if (Runs == 0) {
+		errs() << argv[0] << ": -runs must be at least 1\n";
+		return 1;
+	}
+	OwningPtr<tool_output_file> Out(new tool_output_file(OutputFile.c_str(), error, sys::fs::F_None));
+	if (!error.empty()) {
+		errs() << argv[0] << ": " << error << "\n";
+		return 1;
+	}
+	raw_ostream &os = Out->os();
+	os << "# runs " << Runs << " warmup " << Warmup << "\n";
+	os << "# file\tmetric\tmedian\tp95\n";
+	for (unsigned f = 0; f < InputFiles.size(); f++) {
+		SMDiagnostic Err;
+		OwningPtr<Module> M(ParseIRFile(InputFiles[f], Err, Context));
+		Samples s;
+		if (M.get() == 0) {
+			Err.print(argv[0], errs());
+			return 1;
+		}
+		for (unsigned r = 0; r < Warmup; r++)
+			runOnce(PI, *M, NULL);
+		for (unsigned r = 0; r < Runs; r++)
+			runOnce(PI, *M, &s);
+		// times are in ms, everything else is a count
+		for (unsigned i = 0; i < s.Order.size(); i++) {
+			std::vector<double> &vs = s.Values[s.Order[i]];
+			double med = median(vs);
+			os << InputFiles[f] << "\t" << s.Order[i] << "\t"
+			   << format("%.3f", med) << "\t" << format("%.3f", p95(vs)) << "\n";
+		}
+	}
+	Out->keep();
+	return 0;
+}
@@ -0,0 +1,128 @@
+//===- FSAAExport.cpp - Write final results for other tools ----------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// With -fsaa-export=<file>, the pass writes what its queries are answered
+// from: the name of every id, the final points-to rows with their flags, and
+// the read/write sets of every function. The layout is described in
+// FSAAExportFormat.h; Reader/ has a library and a dump tool for it.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAnalysis.h"
+#include "FSAAExportFormat.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-export"
+
+static cl::opt<std::string> ExportFile("fsaa-export",
+	cl::desc("Write the final points-to sets and mod/ref sets to this file"),
+	cl::value_desc("filename"), cl::init(""));
+
+// round a section offset up to 8 bytes
+static uint64_t align8(uint64_t off) {
+	return (off + 7) & ~(uint64_t)7;
+}
+
+// write a section at off, after padding from the current position pos
+template <typename T>
+static void writeSection(raw_ostream &os, uint64_t &pos, uint64_t off, const std::vector<T> &data) {
+	for (; pos < off; pos++) os << '\0';
+	if (data.empty()) return;
+	os.write((const char*)&data[0],data.size() * sizeof(T));
+	pos += data.size() * sizeof(T);
+}
+
+// append a sorted access set to accesses, return its flag if it is "anything"
+static uint32_t appendAccesses(const AccessSet &s, uint32_t any, std::vector<uint32_t> &accesses,
+		uint32_t &begin, uint32_t &end) {
+	begin = accesses.size();
+	accesses.insert(accesses.end(),s.Locs.begin(),s.Locs.end());
+	end = accesses.size();
+	return s.Any ? any : 0;
+}
+
+void FlowSensitiveAliasAnalysis::exportResults(Module &M) {
+	std::vector<uint32_t> nameOffsets, offsets, targets, accesses;
+	std::vector<uint8_t> flags(LocationCount,0);
+	std::vector<FSAAExportFunction> funcs;
+	std::vector<char> strings;
+	std::vector<FSAAExportHeader> header(1);
+	FSAAExportHeader &h = header[0];
+	std::string error;
+	uint64_t pos = 0;
+	if (ExportFile.empty()) return;
+	// names, by id
+	for (unsigned int i = 0; i < LocationCount; i++) {
+		nameOffsets.push_back(strings.size());
+		if (Int2Str != NULL && Int2Str->count(i))
+			strings.insert(strings.end(),Int2Str->at(i)->begin(),Int2Str->at(i)->end());
+		strings.push_back('\0');
+	}
+	nameOffsets.push_back(strings.size());
+	// rows and flags
+	offsets.assign(PtsOffsets.begin(),PtsOffsets.end());
+	targets.assign(PtsTargets.begin(),PtsTargets.end());
+	for (unsigned int i = 0; i < LocationCount; i++) {
+		if (pointsEverywhere(i)) flags[i] |= FSAA_LOC_EVERYWHERE;
+		if (isConstantLoc(i))    flags[i] |= FSAA_LOC_CONSTANT;
+	}
+	// functions and what they read and write
+	for (Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi) {
+		FSAAExportFunction ef;
+		unsigned fi = Func2Index.lookup(&*mi);
+		memset(&ef,0,sizeof(ef));
+		ef.Id = Value2Int.at(&*mi);
+		if (!mi->isDeclaration()) {
+			ef.Flags = FSAA_FUNC_DEFINED;
+			ef.Flags |= appendAccesses(FuncReads[fi],FSAA_FUNC_READS_ANY,accesses,ef.ReadsBegin,ef.ReadsEnd);
+			ef.Flags |= appendAccesses(FuncWrites[fi],FSAA_FUNC_WRITES_ANY,accesses,ef.WritesBegin,ef.WritesEnd);
+		}
+		funcs.push_back(ef);
+	}
+	// lay the sections out after the header
+	memset(&h,0,sizeof(h));
+	strncpy(h.Magic,FSAA_EXPORT_MAGIC,sizeof(h.Magic));
+	h.Version = FSAA_EXPORT_VERSION;
+	h.ByteOrder = FSAA_EXPORT_BYTEORDER;
+	h.LocationCount = LocationCount;
+	h.FunctionCount = funcs.size();
+	h.NameOffsets = align8(sizeof(h));
+	h.Strings = align8(h.NameOffsets + nameOffsets.size() * sizeof(uint32_t));
+	h.PtsOffsets = align8(h.Strings + strings.size());
+	h.PtsTargets = align8(h.PtsOffsets + offsets.size() * sizeof(uint32_t));
+	h.PtsTargetCount = targets.size();
+	h.LocFlags = align8(h.PtsTargets + targets.size() * sizeof(uint32_t));
+	h.Functions = align8(h.LocFlags + flags.size());
+	h.Accesses = align8(h.Functions + funcs.size() * sizeof(FSAAExportFunction));
+	h.AccessCount = accesses.size();
+	h.FileSize = align8(h.Accesses + accesses.size() * sizeof(uint32_t));
+	raw_fd_ostream os(ExportFile.c_str(),error,sys::fs::F_Binary);
+	if (!error.empty()) {
+		errs() << "fs-aa: cannot write " << ExportFile << ": " << error << "\n";
+		return;
+	}
+	writeSection(os,pos,0,header);
+	writeSection(os,pos,h.NameOffsets,nameOffsets);
+	writeSection(os,pos,h.Strings,strings);
+	writeSection(os,pos,h.PtsOffsets,offsets);
+	writeSection(os,pos,h.PtsTargets,targets);
+	writeSection(os,pos,h.LocFlags,flags);
+	writeSection(os,pos,h.Functions,funcs);
+	writeSection(os,pos,h.Accesses,accesses);
+	writeSection(os,pos,h.FileSize,std::vector<char>());
+	// a failed write must not reach the destructor, which would abort
+	os.close();
+	if (os.has_error()) {
+		os.clear_error();
+		errs() << "fs-aa: cannot write " << ExportFile << "\n";
+		return;
+	}
+	DEBUG(dbgs() << "EXPORTED " << h.FileSize << " BYTES TO " << ExportFile << "\n");
+}
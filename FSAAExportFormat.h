@@ -0,0 +1,65 @@
+//===- FSAAExportFormat.h - On-disk layout of exported fs-aa results -------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// -fsaa-export writes the final results in this layout, so other tools can
+// mmap the file and read it in place. The file starts with a header; every
+// section it points to is an array of fixed-width integers, aligned to 8
+// bytes, in the byte order of the machine that wrote it (see ByteOrder).
+// This header has no LLVM dependencies, the reader includes it as is.
+//
+//===----------------------------------------------------------------------===//
+#ifndef FSAA_EXPORT_FORMAT_H
+#define FSAA_EXPORT_FORMAT_H
+
+#include <stdint.h>
+
+#define FSAA_EXPORT_MAGIC     "FSAAEXP"
+#define FSAA_EXPORT_VERSION   1
+#define FSAA_EXPORT_BYTEORDER 0x01020304u
+
+/// location flags, one byte per id
+#define FSAA_LOC_EVERYWHERE   1     // points to everything
+#define FSAA_LOC_CONSTANT     2     // names a constant global or a function
+
+/// function flags
+#define FSAA_FUNC_DEFINED     1     // has a body (and read/write sets)
+#define FSAA_FUNC_READS_ANY   2     // may read any location
+#define FSAA_FUNC_WRITES_ANY  4     // may write any location
+
+/// FSAAExportHeader - at offset 0; section offsets are from the start of the file
+struct FSAAExportHeader {
+	char     Magic[8];          // FSAA_EXPORT_MAGIC, NUL padded
+	uint32_t Version;           // FSAA_EXPORT_VERSION
+	uint32_t ByteOrder;         // FSAA_EXPORT_BYTEORDER as the writer stored it
+	uint32_t LocationCount;     // ids are 0 .. LocationCount-1, 0 means everything
+	uint32_t FunctionCount;
+	uint64_t FileSize;
+	uint64_t NameOffsets;       // uint32_t[LocationCount+1], name of id i is Strings+NameOffsets[i]
+	uint64_t Strings;           // NUL terminated names, "" for ids without one
+	uint64_t PtsOffsets;        // uint32_t[LocationCount+1], row i is PtsTargets[PtsOffsets[i]..PtsOffsets[i+1])
+	uint64_t PtsTargets;        // uint32_t[PtsTargetCount], each row sorted, without 0,
+	                            // empty for FSAA_LOC_EVERYWHERE ids
+	uint64_t PtsTargetCount;
+	uint64_t LocFlags;          // uint8_t[LocationCount], FSAA_LOC_*
+	uint64_t Functions;         // FSAAExportFunction[FunctionCount], in module order
+	uint64_t Accesses;          // uint32_t[AccessCount], the read/write sets of functions
+	uint64_t AccessCount;
+};
+
+/// FSAAExportFunction - a function and the locations it (and everything it
+/// calls) may read and write, as sorted ranges of the Accesses section
+struct FSAAExportFunction {
+	uint32_t Id;                // id of the function's name
+	uint32_t Flags;             // FSAA_FUNC_*
+	uint32_t ReadsBegin;
+	uint32_t ReadsEnd;
+	uint32_t WritesBegin;
+	uint32_t WritesEnd;
+};
+
+#endif /* FSAA_EXPORT_FORMAT_H */
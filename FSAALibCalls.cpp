@@ -0,0 +1,187 @@
+//===- FSAALibCalls.cpp - Library call summaries for external declarations -===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Calls to external declarations have no SEG to propagate into. For the
+// library functions TargetLibraryInfo recognizes, a summary describes what
+// the call does to pointers: return fresh memory, return (a pointer into)
+// one of its arguments, and/or copy the memory one argument points to into
+// the memory another one points to. Everything else about them is treated
+// as having no effect on pointers, and so are intrinsics other than
+// memcpy/memmove.
+//
+// A declaration without a summary is handled like a call through an
+// undefined function pointer: afterwards anything may point anywhere, and
+// its pointer result points everywhere.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAnalysis.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Intrinsics.h"
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-libcall"
+
+STATISTIC(LibCallsSummarized, "Library declarations with a pointer summary");
+STATISTIC(LibCallsApplied,    "Library call visits handled by a summary");
+
+// summary table, keyed by the library function TargetLibraryInfo finds for a name
+static const struct {
+	LibFunc::Func func;
+	LibCallSummary summary;      // flags, retArg, dstArg, srcArg
+} LibCallTable[] = {
+	// allocation: return value points to fresh memory (a per-site heap
+	// location for the allocators isAllocationFn knows, HeapId for the rest)
+	{ LibFunc::malloc,   { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::calloc,   { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::valloc,   { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::realloc,  { LIBCALL_ALLOC | LIBCALL_RETARG,  0, -1, -1 } },
+	{ LibFunc::Znwj,     { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::Znwm,     { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::Znaj,     { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::Znam,     { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::strdup,   { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::strndup,  { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::fopen,    { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::tmpfile,  { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	{ LibFunc::getenv,   { LIBCALL_ALLOC,                  -1, -1, -1 } },
+	// copy: memory of dst gets the contents of memory of src
+	{ LibFunc::memcpy,   { LIBCALL_COPY | LIBCALL_RETARG,   0,  0,  1 } },
+	{ LibFunc::memmove,  { LIBCALL_COPY | LIBCALL_RETARG,   0,  0,  1 } },
+	// return value points into an argument
+	{ LibFunc::memset,   { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::memchr,   { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strcpy,   { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strncpy,  { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strcat,   { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strncat,  { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strchr,   { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strrchr,  { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strstr,   { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::strpbrk,  { LIBCALL_RETARG,                  0, -1, -1 } },
+	{ LibFunc::fgets,    { LIBCALL_RETARG,                  0, -1, -1 } },
+	// no effect on pointers
+	{ LibFunc::free,     { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::ZdlPv,    { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::ZdaPv,    { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::memcmp,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::strlen,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::strcmp,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::strncmp,  { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::strspn,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::strcspn,  { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::atoi,     { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::atol,     { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::atof,     { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fclose,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fflush,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fread,    { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fwrite,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fgetc,    { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fputc,    { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fputs,    { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::puts,     { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::putchar,  { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::printf,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::fprintf,  { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::sprintf,  { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+	{ LibFunc::perror,   { LIBCALL_NOEFFECT,               -1, -1, -1 } },
+};
+
+#define LIBCALL_TABLE_SIZE (sizeof(LibCallTable)/sizeof(LibCallTable[0]))
+
+// llvm.memcpy/llvm.memmove return void, llvm.memset has no effect on pointers
+static const LibCallSummary MemCopySummary = { LIBCALL_COPY,     -1,  0,  1 };
+static const LibCallSummary NoEffectSummary = { LIBCALL_NOEFFECT, -1, -1, -1 };
+// allocators TLI knows about, but the table doesn't
+static const LibCallSummary AllocSummary = { LIBCALL_ALLOC, -1, -1, -1 };
+
+// find summaries for every declaration in the module we know about
+void FlowSensitiveAliasAnalysis::initializeLibCalls(Module &M) {
+	std::map<LibFunc::Func,const LibCallSummary*> byFunc;
+	LibFunc::Func lf;
+	LibSummaries.clear();
+	for (unsigned int i = 0; i < LIBCALL_TABLE_SIZE; i++)
+		byFunc[LibCallTable[i].func] = &LibCallTable[i].summary;
+	for (Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi) {
+		const Function *f = &*mi;
+		if (!f->isDeclaration()) continue;
+		// memory intrinsics carry their types in the name, so TLI doesn't know them
+		switch (f->getIntrinsicID()) {
+		case Intrinsic::memcpy:
+		case Intrinsic::memmove:
+			LibSummaries[f] = MemCopySummary;
+			break;
+		case Intrinsic::memset:
+			LibSummaries[f] = NoEffectSummary;
+			break;
+		default:
+			if (TLI->getLibFunc(f->getName(),lf) && TLI->has(lf) && byFunc.count(lf))
+				LibSummaries[f] = *byFunc.at(lf);
+			else if (f->isIntrinsic())
+				LibSummaries[f] = NoEffectSummary;
+			else continue;
+		}
+		DEBUG(dbgs() << "LIBCALL SUMMARY FOR: " << f->getName() << "\n");
+		LibCallsSummarized++;
+	}
+}
+
+// where argument n of a call points, or everywhere if it is undefined
+bdd FlowSensitiveAliasAnalysis::libCallArgPointees(bdd *tpts, SEGNode *sn, int n) {
+	if (sn->getArgIds()->at(n) == 0) return fdd_ithvar(1,0);
+	return bdd_restrict(*tpts,sn->getStaticData()->at(n));
+}
+
+// apply the summary of a call to a library declaration
+int FlowSensitiveAliasAnalysis::processLibCall(bdd *tpts, SEGNode *sn, const Function *f) {
+	std::map<const Function*,LibCallSummary>::iterator li = LibSummaries.find(f);
+	const Instruction *i = sn->getInstruction();
+	bool heapSite = HeapSites.count(i) != 0;
+	bdd out, dst, src, contents, newpts;
+	// without a summary, we know nothing about this declaration, unless
+	// TLI told us it is an allocator: treat it like an undefined call
+	if (li == LibSummaries.end() && !heapSite) {
+		DEBUG(dbgs() << "LIBCALL: NO SUMMARY FOR " << f->getName() << "\n");
+		// it's outset has everything -> everything
+		sn->setOutSet(bdd_true());
+		propagateAddrTaken(sn);
+		// and it's return value points everywhere
+		if (i->getType()->isPointerTy() && Value2Int.count(i)) {
+			newpts = fdd_ithvar(0,Value2Int.at(i));
+			propagateTopLevel(tpts,&newpts,sn);
+		}
+		return 0;
+	}
+	const LibCallSummary &ls = li == LibSummaries.end() ? AllocSummary : li->second;
+	LibCallsApplied++;
+	out = sn->getInSet();
+	// memory dst points to may now hold whatever memory src points to holds
+	if (ls.flags & LIBCALL_COPY) {
+		dst = libCallArgPointees(tpts,sn,ls.dstArg);
+		src = libCallArgPointees(tpts,sn,ls.srcArg);
+		if (bdd_sat(src & fdd_ithvar(1,0))) contents = fdd_ithvar(1,0);
+		else contents = bdd_relprod(sn->getInSet(),out2in(src),fdd_ithset(0));
+		if (bdd_sat(dst & fdd_ithvar(1,0))) dst = bdd_true();
+		else dst = out2in(dst);
+		DEBUG(dbgs() << "LIBCALL: COPY\n"; printBDD(LocationCount,Int2Str,dst & contents));
+		out |= dst & contents;
+	}
+	sn->setOutSet(out);
+	propagateAddrTaken(sn);
+	// nothing more to do if the returned pointer is never used
+	if (!i->getType()->isPointerTy() || !Value2Int.count(i)) return 0;
+	newpts = bdd_false();
+	// allocation sites return their own heap location, like alloca
+	if (heapSite)                           newpts |= fdd_ithvar(1,Value2Int.at(i)+1);
+	else if (ls.flags & LIBCALL_ALLOC)      newpts |= fdd_ithvar(1,HeapId);
+	if (ls.flags & LIBCALL_RETARG)          newpts |= libCallArgPointees(tpts,sn,ls.retArg);
+	newpts &= fdd_ithvar(0,Value2Int.at(i));
+	propagateTopLevel(tpts,&newpts,sn);
+	return 0;
+}
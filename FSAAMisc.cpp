@@ -11,54 +11,56 @@
   } while(0)
 #define ss(s) std::string(s)
 
-// build reverseMap (for debugging purposes)
-std::map<unsigned int,std::string*> *reverseMap(std::map<const Value*,unsigned int> *m) {
+// build reverseMap (for debugging purposes, and the names of exported results)
+std::map<unsigned int,std::string*> *reverseMap(std::map<const Value*,unsigned int> *m, std::set<const Value*> *heaps) {
 	std::pair<std::map<unsigned int,std::string*>::iterator,bool> ret;
 	std::map<unsigned int,std::string *> *inv = new std::map<unsigned int,std::string*>();
 	std::string *name;
 	std::string prename;
 	char buf[100];
-	unsigned int anon = 1;
-	// build inverse map (also check map is 1-to-1)
-	for (std::map<const Value*,unsigned int>::iterator it = m->begin(); it != m->end(); ++it) {
-		const Value *v = it->first;
-		unsigned int id = it->second;
-		// if value is anonymous, give it a numeric name
-		if (v->getName().size() == 0) {
-			assert(snprintf(buf,100,"%d",anon++) < 100);
-			prename = ss(buf);
-		} else prename = v->getName();
-		// if value is an instruction or argument, add it's function's parent name
-		if (isa<Instruction>(v))
-			name = new ss(ss(cast<Instruction>(v)->getParent()->getParent()->getName())+"_"+ss(prename));
-		else if (isa<Argument>(v))
-			name = new ss(ss(cast<Argument>(v)->getParent()->getName())+"_"+ss(prename));
-		else
-			name = new ss(prename);
-/*#ifdef ENABLE_OPT_1
-		// in the opt1 version, they are not assigned an id, they share the id with
-		// source value used at right hand side
-		// insert will fail.
-		if (isa<GetElementPtrInst>(v) | isa<CastInst>(v))
-			continue;
-#endif*/
-		DEBUG(v->dump());
-		// add hidden names for each value type that has hidden values
-		if (isa<AllocaInst>(v)) {
-			insertName(inv,ret,id,name);
-			insertName(inv,ret,id+1,new ss(*name + "__HEAP"));
-		} else if (isa<GlobalVariable>(v)) {
-			insertName(inv,ret,id,name);
-			insertName(inv,ret,id+1,new ss(*name + "__VALUE"));
-		} else if (isa<Function>(v)) {
-			insertName(inv,ret,id,name);
-			insertName(inv,ret,id+1,new ss(*name + "__FUNCTION"));
-		} else if (isa<Argument>(v)) {
-			insertName(inv,ret,id,name);
-			insertName(inv,ret,id+1,new ss(*name + "__ARGUMENT"));
-		// otherwise, store regular name only
-		} else {
-			insertName(inv,ret,id,name);
+	// build inverse map; copies (geps, casts) share the id of their source,
+	// so they go last and only name ids nothing else named, which keeps the
+	// names independent of where values happen to be in memory
+	for (int pass = 0; pass < 2; pass++) {
+		for (std::map<const Value*,unsigned int>::iterator it = m->begin(); it != m->end(); ++it) {
+			const Value *v = it->first;
+			unsigned int id = it->second;
+			if ((isa<GetElementPtrInst>(v) || isa<CastInst>(v)) != (pass == 1))
+				continue;
+			if (pass == 1 && inv->count(id))
+				continue;
+			// if value is anonymous, name it by its id
+			if (v->getName().size() == 0) {
+				int n = snprintf(buf,100,"%u",id);
+				assert(n > 0 && n < 100);
+				(void)n;
+				prename = ss(buf);
+			} else prename = v->getName();
+			// if value is an instruction or argument, add it's function's parent name
+			if (isa<Instruction>(v))
+				name = new ss(ss(cast<Instruction>(v)->getParent()->getParent()->getName())+"_"+ss(prename));
+			else if (isa<Argument>(v))
+				name = new ss(ss(cast<Argument>(v)->getParent()->getName())+"_"+ss(prename));
+			else
+				name = new ss(prename);
+			DEBUG(v->dump());
+			// add hidden names for each value type that has hidden values
+			if (isa<AllocaInst>(v) || (heaps != NULL && heaps->count(v))) {
+				insertName(inv,ret,id,name);
+				insertName(inv,ret,id+1,new ss(*name + "__HEAP"));
+			} else if (isa<GlobalVariable>(v)) {
+				insertName(inv,ret,id,name);
+				insertName(inv,ret,id+1,new ss(*name + "__VALUE"));
+			} else if (isa<Function>(v)) {
+				insertName(inv,ret,id,name);
+				insertName(inv,ret,id+1,new ss(*name + "__FUNCTION"));
+			} else if (isa<Argument>(v)) {
+				insertName(inv,ret,id,name);
+				insertName(inv,ret,id+1,new ss(*name + "__ARGUMENT"));
+			// otherwise, store regular name only
+			} else {
+				insertName(inv,ret,id,name);
+			}
 		}
 	}
 	// store everything value
@@ -0,0 +1,206 @@
+//===- FSAAModRef.cpp - Mod/ref answers from per-function access sets ------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Once the final points-to rows exist, every load and store in a function
+// reads or writes the locations its pointer operand points to. Calls add
+// what their callees touch: library declarations with a summary touch what
+// their pointer arguments point to, and defined callees (direct, or the
+// targets indirect calls resolved to) pass on their own sets. Indirect calls
+// also count every address-taken declaration of their type, which the rows
+// cannot name. The sets are closed over the call graph, and the mod/ref
+// hooks answer from them.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAnalysis.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/InstIterator.h"
+#include <iterator>
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-modref"
+
+STATISTIC(ReadOnlyFunctions, "Functions found to only read memory");
+STATISTIC(NoMemoryFunctions, "Functions found not to touch memory");
+STATISTIC(ModRefImproved,    "Call mod/ref queries answered better than ModRef");
+
+// to |= from, true if to changed
+static bool mergeAccesses(AccessSet &to, const AccessSet &from) {
+	std::vector<unsigned> merged;
+	if (to.Any) return false;
+	if (from.Any) {
+		to.Any = true;
+		to.Locs.clear();
+		return true;
+	}
+	if (std::includes(to.Locs.begin(),to.Locs.end(),from.Locs.begin(),from.Locs.end()))
+		return false;
+	std::set_union(to.Locs.begin(),to.Locs.end(),from.Locs.begin(),from.Locs.end(),std::back_inserter(merged));
+	to.Locs.swap(merged);
+	return true;
+}
+
+// add the locations p points to
+void FlowSensitiveAliasAnalysis::addPointees(AccessSet &s, const Value *p) {
+	unsigned int v = valueId(p);
+	AccessSet row;
+	// unmapped pointers (constant expressions, casts from integers) may be anywhere
+	if (v == 0 || pointsEverywhere(v)) row.Any = true;
+	else row.Locs.assign(PtsTargets.begin()+PtsOffsets[v],PtsTargets.begin()+PtsOffsets[v+1]);
+	mergeAccesses(s,row);
+}
+
+// what a call to declaration f touches, from the caller's point of view
+void FlowSensitiveAliasAnalysis::addCallAccesses(ImmutableCallSite cs, const Function *f, AccessSet &reads, AccessSet &writes) {
+	bool args = LibSummaries.count(f) || HeapSites.count(cs.getInstruction()) || f->isIntrinsic();
+	if (f->doesNotAccessMemory()) return;
+	// summarized library calls and intrinsics only go through their pointer arguments
+	if (args) {
+		for (ImmutableCallSite::arg_iterator ai = cs.arg_begin(), ae = cs.arg_end(); ai != ae; ++ai) {
+			if (!(*ai)->getType()->isPointerTy()) continue;
+			addPointees(reads,*ai);
+			if (!f->onlyReadsMemory()) addPointees(writes,*ai);
+		}
+		return;
+	}
+	// everything else may touch anything
+	reads.Any = true;
+	reads.Locs.clear();
+	if (f->onlyReadsMemory()) return;
+	writes.Any = true;
+	writes.Locs.clear();
+}
+
+void FlowSensitiveAliasAnalysis::computeAccessSets(Module &M) {
+	unsigned n = Func2SEG.size();
+	std::vector<std::vector<unsigned> > callees(n), callers(n);
+	std::deque<unsigned> work;
+	std::vector<bool> queued(n,true);
+	std::map<FunctionType*,std::vector<const Function*> > escaped;
+	FuncReads.assign(n,AccessSet());
+	FuncWrites.assign(n,AccessSet());
+	// declarations have no hidden pair, so no points-to row names them: an
+	// indirect call may reach any address-taken declaration of its type
+	for (Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi)
+		if (mi->isDeclaration() && mi->hasAddressTaken())
+			escaped[mi->getFunctionType()].push_back(&*mi);
+	for (Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi) {
+		const Function *f = &*mi;
+		unsigned fi = Func2Index.lookup(f);
+		AccessSet &reads = FuncReads[fi], &writes = FuncWrites[fi];
+		// declarations are only seen through their call sites
+		if (f->isDeclaration()) continue;
+		for (const_inst_iterator ii = inst_begin(f), ie = inst_end(f); ii != ie; ++ii) {
+			const Instruction *i = &*ii;
+			if (const LoadInst *ld = dyn_cast<LoadInst>(i)) addPointees(reads,ld->getPointerOperand());
+			else if (const StoreInst *sr = dyn_cast<StoreInst>(i)) addPointees(writes,sr->getPointerOperand());
+			else if (isa<AtomicRMWInst>(i) || isa<AtomicCmpXchgInst>(i) || isa<VAArgInst>(i)) {
+				addPointees(reads,i->getOperand(0));
+				addPointees(writes,i->getOperand(0));
+			} else if (isa<CallInst>(i) || isa<InvokeInst>(i)) {
+				ImmutableCallSite cs(i);
+				const Value *callee = cs.getCalledValue()->stripPointerCasts();
+				unsigned int v = valueId(callee);
+				std::vector<const Function*> targets;
+				if (const Function *target = dyn_cast<Function>(callee)) targets.push_back(target);
+				// indirect calls go wherever the final points-to set of the callee
+				// says; inline asm and unknown callees may do anything
+				else if (v != 0 && !pointsEverywhere(v)) {
+					const PointerType *pt = cast<PointerType>(cs.getCalledValue()->getType());
+					std::map<FunctionType*,std::vector<const Function*> >::iterator ei =
+						escaped.find(cast<FunctionType>(pt->getElementType()));
+					for (unsigned k = PtsOffsets[v]; k < PtsOffsets[v+1]; k++)
+						if (PtsTargets[k] < Int2Func.size() && Int2Func[PtsTargets[k]] != NULL)
+							targets.push_back(Int2Func[PtsTargets[k]]);
+					if (ei != escaped.end()) targets.insert(targets.end(),ei->second.begin(),ei->second.end());
+				} else {
+					reads.Any = writes.Any = true;
+					reads.Locs.clear();
+					writes.Locs.clear();
+				}
+				for (unsigned k = 0; k < targets.size(); k++) {
+					if (targets[k]->isDeclaration()) addCallAccesses(cs,targets[k],reads,writes);
+					else callees[fi].push_back(Func2Index.lookup(targets[k]));
+				}
+			}
+		}
+		std::sort(callees[fi].begin(),callees[fi].end());
+		callees[fi].erase(std::unique(callees[fi].begin(),callees[fi].end()),callees[fi].end());
+		for (unsigned k = 0; k < callees[fi].size(); k++)
+			callers[callees[fi][k]].push_back(fi);
+		work.push_back(fi);
+	}
+	// pull callee sets into callers until nothing changes
+	while (!work.empty()) {
+		unsigned fi = work.front();
+		bool changed = false;
+		work.pop_front();
+		queued[fi] = false;
+		for (unsigned k = 0; k < callees[fi].size(); k++) {
+			changed |= mergeAccesses(FuncReads[fi],FuncReads[callees[fi][k]]);
+			changed |= mergeAccesses(FuncWrites[fi],FuncWrites[callees[fi][k]]);
+		}
+		if (!changed) continue;
+		for (unsigned k = 0; k < callers[fi].size(); k++) {
+			if (queued[callers[fi][k]]) continue;
+			queued[callers[fi][k]] = true;
+			work.push_back(callers[fi][k]);
+		}
+	}
+	for (Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi) {
+		unsigned fi = Func2Index.lookup(&*mi);
+		bool reads, writes;
+		if (mi->isDeclaration()) continue;
+		reads = FuncReads[fi].Any || !FuncReads[fi].Locs.empty();
+		writes = FuncWrites[fi].Any || !FuncWrites[fi].Locs.empty();
+		DEBUG(dbgs() << "ACCESSES: " << mi->getName() << (reads ? " READS" : "") << (writes ? " WRITES" : "") << "\n");
+		if (!reads && !writes) NoMemoryFunctions++;
+		else if (!writes) ReadOnlyFunctions++;
+	}
+}
+
+bool FlowSensitiveAliasAnalysis::mayAccess(const AccessSet &s, unsigned int v) {
+	std::vector<unsigned>::const_iterator i1, e1, i2, e2;
+	if (s.Any) return true;
+	if (v == 0 || pointsEverywhere(v)) return !s.Locs.empty();
+	i1 = s.Locs.begin(); e1 = s.Locs.end();
+	i2 = PtsTargets.begin()+PtsOffsets[v]; e2 = PtsTargets.begin()+PtsOffsets[v+1];
+	while (i1 != e1 && i2 != e2) {
+		if (*i1 < *i2) ++i1;
+		else if (*i2 < *i1) ++i2;
+		else return true;
+	}
+	return false;
+}
+
+AliasAnalysis::ModRefBehavior FlowSensitiveAliasAnalysis::getModRefBehavior(const Function *F) {
+	DenseMap<const Function*, unsigned>::iterator fi = Func2Index.find(F);
+	ModRefBehavior Min = UnknownModRefBehavior;
+	if (fi != Func2Index.end() && fi->second < FuncReads.size() && !F->isDeclaration()) {
+		const AccessSet &reads = FuncReads[fi->second], &writes = FuncWrites[fi->second];
+		if (!writes.Any && writes.Locs.empty())
+			Min = !reads.Any && reads.Locs.empty() ? DoesNotAccessMemory : OnlyReadsMemory;
+	}
+	return ModRefBehavior(AliasAnalysis::getModRefBehavior(F) & Min);
+}
+
+AliasAnalysis::ModRefResult FlowSensitiveAliasAnalysis::getModRefInfo(ImmutableCallSite CS, const Location &Loc) {
+	const Function *F = CS.getCalledFunction();
+	DenseMap<const Function*, unsigned>::iterator fi;
+	unsigned Mask = ModRef;
+	// only direct calls to defined functions have a set of their own
+	if (F != NULL && !F->isDeclaration() && (fi = Func2Index.find(F)) != Func2Index.end() &&
+			fi->second < FuncReads.size()) {
+		unsigned int v = valueId(Loc.Ptr);
+		Mask = NoModRef;
+		if (mayAccess(FuncReads[fi->second],v)) Mask |= Ref;
+		if (mayAccess(FuncWrites[fi->second],v)) Mask |= Mod;
+		if (Mask != ModRef) ModRefImproved++;
+	}
+	return ModRefResult(Mask & AliasAnalysis::getModRefInfo(CS,Loc));
+}
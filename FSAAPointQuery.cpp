@@ -0,0 +1,141 @@
+//===- FSAAPointQuery.cpp - Program point alias and points-to queries ------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// With -fsaa-keep-sets, the SEGs outlive the solve, and clients can ask what
+// address-taken memory holds just before a given instruction. Only loads,
+// stores, calls and returns have SEG nodes with their own sets; any other
+// instruction sees the In set of the next such node in its block, the Out
+// set of the previous one, or, in a block without any, whatever flows in
+// from the predecessor blocks. The answer for every instruction of a
+// function is indexed on the first query into that function.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAnalysis.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CFG.h"
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-pointquery"
+
+STATISTIC(PointQueries,       "Program point queries answered");
+STATISTIC(PointIndexBuilt,    "Functions indexed for program point queries");
+
+// instructions that keep a SEG node with its own address-taken sets
+static bool hasMemoryNode(const Instruction *i) {
+	return isa<LoadInst>(i) || isa<StoreInst>(i) || isa<CallInst>(i) ||
+		isa<InvokeInst>(i) || isa<ReturnInst>(i);
+}
+
+void FlowSensitiveAliasAnalysis::buildPointIndex(SEG *seg) {
+	const Function *f = seg->getFunction();
+	DenseMap<const Instruction*,bdd> *index = new DenseMap<const Instruction*,bdd>();
+	DenseMap<const BasicBlock*,bdd> exitState;
+	std::vector<const BasicBlock*> bare;
+	bdd entryState = seg->getEntryNode()->getOutSet();
+	bool changed = true;
+	// blocks with memory nodes: before the first node an instruction sees its
+	// In set, after a node it sees that node's Out set
+	for (Function::const_iterator bi = f->begin(), be = f->end(); bi != be; ++bi) {
+		const BasicBlock *b = &*bi;
+		SEGNode *next = NULL;
+		for (BasicBlock::const_iterator ii = b->end(), ie = b->begin(); ii != ie; ) {
+			const Instruction *i = &*--ii;
+			if (hasMemoryNode(i)) next = Inst2Node.at(i);
+			if (next != NULL) (*index)[i] = next->getInSet();
+		}
+		if (next == NULL) {
+			bare.push_back(b);
+			exitState[b] = bdd_false();
+			continue;
+		}
+		for (BasicBlock::const_iterator ii = b->begin(), ie = b->end(); ii != ie; ++ii) {
+			const Instruction *i = &*ii;
+			if (!hasMemoryNode(i) && index->count(i) == 0)
+				(*index)[i] = next->getOutSet();
+			if (hasMemoryNode(i)) {
+				next = Inst2Node.at(i);
+				exitState[b] = next->getOutSet();
+			}
+		}
+	}
+	// blocks without memory nodes pass on whatever flows into them
+	while (changed) {
+		changed = false;
+		for (unsigned k = 0; k < bare.size(); k++) {
+			const BasicBlock *b = bare[k];
+			bdd in = b == &f->getEntryBlock() ? entryState : bdd_false();
+			for (const_pred_iterator pi = pred_begin(b), pe = pred_end(b); pi != pe; ++pi)
+				in |= exitState[*pi];
+			if (in == exitState[b]) continue;
+			exitState[b] = in;
+			changed = true;
+		}
+	}
+	for (unsigned k = 0; k < bare.size(); k++)
+		for (BasicBlock::const_iterator ii = bare[k]->begin(), ie = bare[k]->end(); ii != ie; ++ii)
+			(*index)[&*ii] = exitState[bare[k]];
+	PointIndex[seg->getIndex()] = index;
+	PointIndexBuilt++;
+}
+
+bool FlowSensitiveAliasAnalysis::memoryStateAt(const Instruction *I, bdd &state) {
+	const Function *f = I->getParent()->getParent();
+	DenseMap<const Function*, unsigned>::iterator fi;
+	if (!SetsKept || (fi = Func2Index.find(f)) == Func2Index.end()) return false;
+	// calls to summarized functions are solved inside the caller, the SEG
+	// never sees the caller's memory
+	if (hasSummary(Func2SEG[fi->second]) && !f->use_empty()) return false;
+	if (PointIndex[fi->second] == NULL) buildPointIndex(Func2SEG[fi->second]);
+	state = PointIndex[fi->second]->lookup(I);
+	return true;
+}
+
+bool FlowSensitiveAliasAnalysis::pointsToAt(const Location &Loc, const Instruction *I, std::vector<unsigned> &pointees) {
+	unsigned int v = valueId(Loc.Ptr);
+	bdd state, locs;
+	pointees.clear();
+	if (!memoryStateAt(I,state)) return false;
+	PointQueries++;
+	// if we don't know where Loc is, it may hold anything
+	if (v == 0 || pointsEverywhere(v)) {
+		pointees.push_back(0);
+		return true;
+	}
+	// what the locations Loc.Ptr points to hold, and what was stored everywhere
+	locs = fdd_ithvar(0,0);
+	for (unsigned k = PtsOffsets[v]; k < PtsOffsets[v+1]; k++)
+		locs |= fdd_ithvar(0,PtsTargets[k]);
+	bddDomainValues(bdd_relprod(state,locs,fdd_ithset(0)),1,pointees);
+	return true;
+}
+
+AliasAnalysis::AliasResult FlowSensitiveAliasAnalysis::aliasAt(const Location &LocA, const Location &LocB, const Instruction *I) {
+	std::vector<unsigned> a, b;
+	std::vector<unsigned>::const_iterator i1, e1, i2, e2;
+	if (!pointsToAt(LocA,I,a) || !pointsToAt(LocB,I,b)) return MayAlias;
+	// pointee lists are sorted, so anything (0) comes first
+	if ((!a.empty() && a[0] == 0) || (!b.empty() && b[0] == 0)) return MayAlias;
+	i1 = a.begin(); e1 = a.end();
+	i2 = b.begin(); e2 = b.end();
+	while (i1 != e1 && i2 != e2) {
+		if (*i1 < *i2) ++i1;
+		else if (*i2 < *i1) ++i2;
+		else return MayAlias;
+	}
+	return NoAlias;
+}
+
+void FlowSensitiveAliasAnalysis::releaseSets() {
+	for (unsigned k = 0; k < PointIndex.size(); k++)
+		delete PointIndex[k];
+	PointIndex.clear();
+	clean();
+	pointsToFinalize();
+	SetsKept = false;
+}
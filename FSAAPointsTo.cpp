@@ -75,14 +75,6 @@ STATISTIC(UndefStore,"Number of undef stores");
  * use global variable to determine number of dimensions, etc...
  */
 
-// append node to list if not present, return true if append occurred
-template <class T>
-bool inline appendIfAbsent(std::list<T> *wkl, T elt) {
-	typename std::list<T>::iterator i = std::find(wkl->begin(), wkl->end(), elt);
-	if (i == wkl->end()) wkl->push_back(elt);
-	return i == wkl->end();
-}
-
 // propagate top level without strong update
 bool FlowSensitiveAliasAnalysis::propagateTopLevel(bdd *oldtpts, bdd *newpart, SEGNode *sn) {
 	bdd tmp = bdd_true();
@@ -93,8 +85,7 @@ bool FlowSensitiveAliasAnalysis::propagateTopLevel(bdd *oldtpts, bdd *newpart, S
 #define DEBUG_TYPE "fsaa-propagatetoplevel"
 // propagate top level with strong update
 bool FlowSensitiveAliasAnalysis::propagateTopLevel(bdd *oldtpts, bdd *newpart, bdd* update, SEGNode *sn) {
-	const Function *f = sn->getParent()->getFunction();
-	std::list<SEGNode*> *wkl = StmtWorkList.at(f);
+	SEG *seg = sn->getParent();
 	bool changed = false;
 	DEBUG(dbgs() << "NEWPTS:\n"; printBDD(LocationCount,Int2Str,*newpart));
 	// if old and new are different, add all users to worklist
@@ -102,10 +93,10 @@ bool FlowSensitiveAliasAnalysis::propagateTopLevel(bdd *oldtpts, bdd *newpart, b
 		DEBUG(dbgs() << "PROPAGATE TOPLEVEL FOR: "<<*sn<<"\n");
 		// only append to worklist if absent
 		for(SEGNode::const_user_iterator i = sn->user_begin(); i != sn->user_end(); ++i)
-			if (appendIfAbsent<SEGNode*>(wkl,*i)) {
+			if (queueNode(*i)) {
 				changed = true;
-				DEBUG(dbgs() << "TOPLEVEL: APPENDED " << **i << " TO " << f->getName() << "'S WORKLIST\n");
-				appendIfAbsent<const Function*>(&FuncWorkList,f);
+				DEBUG(dbgs() << "TOPLEVEL: APPENDED " << **i << " TO " << seg->getFunction()->getName() << "'S WORKLIST\n");
+				queueFunction(seg);
 			}
 	}
 #undef  DEBUG_TYPE
@@ -125,8 +116,7 @@ bool FlowSensitiveAliasAnalysis::propagateTopLevel(bdd *oldtpts, bdd *newpart, b
 // propagate address taken
 bool FlowSensitiveAliasAnalysis::propagateAddrTaken(SEGNode *sn) {
 	bdd oldink, newink;
-	const Function *f = sn->getParent()->getFunction();
-	std::list<SEGNode*> *wkl = StmtWorkList.at(f);
+	SEG *seg = sn->getParent();
 	bool changed = false;
 	// add all changed successors to the worklist
 	for(SEGNode::const_succ_iterator i = sn->succ_begin(); i != sn->succ_end(); ++i) {
@@ -137,10 +127,10 @@ bool FlowSensitiveAliasAnalysis::propagateAddrTaken(SEGNode *sn) {
 		// append to worklist if inset changed and not already in worklist
 		if (oldink != newink){
 			DEBUG(dbgs()<<"PROPAGATE ADDRTAKEN FOR: "<<*sn<<"\n");
-			if (appendIfAbsent<SEGNode*>(wkl,succ)) {
+			if (queueNode(succ)) {
 				changed = true;
-				DEBUG(dbgs() << "ADDRTAKEN: APPENDED " << **i << " TO " << f->getName() << "'S WORKLIST\n");
-				appendIfAbsent<const Function*>(&FuncWorkList,f);
+				DEBUG(dbgs() << "ADDRTAKEN: APPENDED " << **i << " TO " << seg->getFunction()->getName() << "'S WORKLIST\n");
+				queueFunction(seg);
 			}
 			succ->setInSet(newink);
 		}
@@ -365,24 +355,27 @@ int FlowSensitiveAliasAnalysis::processStore(bdd *tpts, SEGNode *sn) {
 
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "fsaa-preprocess"
-// TODO: reachability is too strict; get closure over points-to
-// ret bdd with pairs that originate either from an argument or a global variable
-bdd genFilterSet(bdd inset, bdd gvarpts, bdd argset) {
-	// if filter can point anywhere, return whole inset
-	bdd filter = (argset | gvarpts) & inset;
-	if (bdd_sat(filter & fdd_ithvar(1,0))) return inset;
-	else return filter;
+// ret bdd with pairs of inset whose location is reachable from roots (a set of
+// locations in domain 1: pointees of the arguments and the global variables);
+// nothing else can be seen by a callee, so the rest bypasses the call
+bdd genFilterSet(bdd inset, bdd roots) {
+	bdd reach = roots, frontier = roots;
+	// close over points-to: whatever a reachable location points to is reachable
+	while (bdd_sat(frontier)) {
+		// if anything reachable can point anywhere, the callee sees the whole inset
+		if (bdd_sat(frontier & fdd_ithvar(1,0))) return inset;
+		frontier = bdd_relprod(inset,out2in(frontier),fdd_ithset(0)) - reach;
+		reach |= frontier;
+	}
+	return inset & out2in(reach);
 }
 
 // get set of functions whose type matches this calls type
 bdd FlowSensitiveAliasAnalysis::matchingFunctions(const Value *funCall) {
-	std::map<unsigned int,const Function *>::iterator fp;
 	const Type *callType = funCall->getType()->getPointerElementType();
-	bdd funs = bdd_false();
-	for (fp = Int2Func.begin(); fp != Int2Func.end(); ++fp)
-		if (fp->second->getType() == callType)
-			funs |= fdd_ithvar(0,fp->first);
-	return funs;
+	std::map<const Type*,bdd>::iterator ti = Type2Funcs.find(callType);
+	if (ti == Type2Funcs.end()) return bdd_false();
+	return out2in(ti->second);
 }
 
 int FlowSensitiveAliasAnalysis::preprocessCall(SEGNode *sn) {
@@ -466,8 +459,16 @@ std::vector<const Function*>
 FlowSensitiveAliasAnalysis::computeTargets(bdd *tpts, SEGNode* funNode, int funId, bdd funName, Type *funType)
 {
 	std::vector<const Function*> targets;
-	std::map<unsigned int,const Function *>::iterator fmit;
+	std::vector<unsigned int> targetIds;
+	std::map<const Type*,bdd>::iterator ti;
 	bdd fpts;
+	// only functions of the call's type can be targets
+	// NOTE: if this would be a bad call, C semantics is undefined and we don't care
+	ti = Type2Funcs.find(funType);
+	if (ti == Type2Funcs.end()) {
+		DEBUG(dbgs() << "NO FUNCTIONS OF TYPE: " << *funType << "\n");
+		return targets;
+	}
 	// if function is defined and doesn't point everywhere, compute it's points-to set
 	if (funId && !pointsTo(*tpts,funId,0)) {
 		DEBUG(dbgs() << "FUN IS DEFINED!\n");
@@ -480,47 +481,32 @@ FlowSensitiveAliasAnalysis::computeTargets(bdd *tpts, SEGNode* funNode, int funI
 	}
 	// find which functions pointer points-to and types agree, add to targets
 	DEBUG(dbgs() << "FPTS\n"; printBDD(LocationCount,Int2Str,fpts));
-	for (fmit = Int2Func.begin(); fmit != Int2Func.end(); ++fmit) {
-		// get potential target information
-		int targetId = fmit->first;
-		bdd targetName = fdd_ithvar(1,targetId);
-		const Function* target = fmit->second;
-		const Type *targetType = target->getFunctionType();
-		DEBUG(dbgs() << "CHECK FUNTYPE: "; funType->dump(); dbgs() << " TARGET: " << target->getName() << " : "; targetType->dump(); dbgs() << "\n");
-		// check if function pointer points to target
-		if (bdd_sat(fpts & targetName)) {
-			// if so, check if their types match
-			if (targetType == funType) {
-				DEBUG(dbgs() << "TARGET ADDED\n");
-				// add target function to targest list
-				targets.push_back(target);
-				// add target function to caller map with this node as it's caller
-				DEBUG(dbgs() << "ATTEMPTING TO ADD CALLER\n");
-				addCaller(funNode,target);
-			// otherwise, fail (may change this later)
-			} else
-				DEBUG(dbgs() << "TARGET TYPE MISMATCH\n");
-			// NOTE: if this would be a bad call, C semantics is undefined and we don't care
-			// else assert(false && "Types should agree");
-		// pointer does NOT point to target
-		} else DEBUG(dbgs() << "NOT IN POINTS-TO SET\n");
+	bddDomainValues(fpts & ti->second,1,targetIds);
+	for (std::vector<unsigned int>::iterator it = targetIds.begin(); it != targetIds.end(); ++it) {
+		const Function* target = Int2Func[*it];
+		DEBUG(dbgs() << "TARGET ADDED: " << target->getName() << "\n");
+		// add target function to targest list
+		targets.push_back(target);
 	}
 	return targets;
 }
 
 // propagate points-to information from caller to callee
-void FlowSensitiveAliasAnalysis::processTarget(bdd *tpts, SEGNode *callNode, bdd filter, const Function *target) {
+// targets that were already processed from this call only receive what changed since
+void FlowSensitiveAliasAnalysis::processTarget(bdd *tpts, SEGNode *callNode, CallData *cd, std::vector<bdd> &argpts, bdd filter, const Function *target) {
 	std::vector<bdd> *params, *call_args;
 	unsigned int paramId, argId, argsize;
-	bdd paramName, argName, kill, newpts;
-	bool varargs;
+	bdd paramName, kill, newpts;
+	bool varargs, known;
 	// get necessary data
-	SEGNode *entry = Func2SEG.at(target)->getEntryNode();
+	SEG *targetSEG = getSEG(target);
+	SEGNode *entry = targetSEG->getEntryNode();
 	params = entry->getStaticData();
 	call_args = callNode->getStaticData();
 	varargs = target->isVarArg();
+	known = cd->knownTargets.count(target) != 0;
 	// debugging calls
-	DEBUG(dbgs() << "TARGET: " << target->getName() << "\n");
+	DEBUG(dbgs() << "TARGET: " << target->getName() << (known ? " (KNOWN)" : " (NEW)") << "\n");
 	assert(params != NULL && call_args != NULL);
 	assert(params->size() == call_args->size() ||
 		(varargs && params->size() <= call_args->size()));
@@ -529,14 +515,21 @@ void FlowSensitiveAliasAnalysis::processTarget(bdd *tpts, SEGNode *callNode, bdd
 	for (unsigned int i = 0; i < argsize; i++) {
 		// get necessary data
 		paramName = params->at(i);
-		argName = call_args->at(i);
 		argId = callNode->getArgIds()->at(i);
 		paramId = entry->getArgIds()->at(i);
+		// known target: parameter already has everything up to the last visit,
+		// and an undefined argument already made it point everywhere
+		if (known) {
+			if (argId == 0) continue;
+			newpts = paramName & (argpts.at(i) - cd->lastArgPts.at(i));
+			if (bdd_unsat(newpts)) continue;
+			kill = bdd_true();
+		}
 		// if argument is defined, add p -> Top(a)
 		// and stong update to delete p -> p__argument
-		if (argId != 0) {
+		else if (argId != 0) {
 			DEBUG(dbgs() << "KILL: " << paramId+1 << "\n");
-			newpts = paramName & bdd_restrict(*tpts,argName);
+			newpts = paramName & argpts.at(i);
 			kill = bdd_not(paramName & fdd_ithvar(1,paramId+1));
 		}
 		// else, add p -> everything
@@ -547,6 +540,16 @@ void FlowSensitiveAliasAnalysis::processTarget(bdd *tpts, SEGNode *callNode, bdd
 		// propagate top level for callee
 		propagateTopLevel(tpts,&newpts,&kill,entry);
 	}
+	// only the part of the filter the target hasn't seen yet can change its entry
+	if (known) {
+		filter = filter - cd->lastFilter;
+		if (bdd_unsat(filter)) return;
+	} else {
+		// first time we see this target, so register the call for its returns
+		DEBUG(dbgs() << "ATTEMPTING TO ADD CALLER\n");
+		addCaller(callNode,target);
+		cd->knownTargets.insert(target);
+	}
 	// get SEG entry node's inset
 	entry->setInSet(entry->getInSet() | filter);
 	entry->setOutSet(entry->getInSet());
@@ -557,11 +560,11 @@ void FlowSensitiveAliasAnalysis::processTarget(bdd *tpts, SEGNode *callNode, bdd
 int FlowSensitiveAliasAnalysis::processCall(bdd *tpts, SEGNode *sn) {
 	// declare some variables we need
 	std::vector<const Function*>::iterator target;
-	std::vector<const Function*> targets;
+	std::vector<const Function*> targets, entered;
+	std::vector<bdd> argpts;
 	CallData *cd;
-	bdd filter;
+	bdd filter, roots, summaryOut;
 	// setup some data we need
-	filter = sn->getInSet();
 	cd = static_cast<CallData*>(sn->getExtraData());
 	DEBUG(dbgs() << "FUNTYPE: " << *(cd->funcType) << "\n");
 	// if func is undefined but not a pointer
@@ -585,18 +588,39 @@ int FlowSensitiveAliasAnalysis::processCall(bdd *tpts, SEGNode *sn) {
 	// else get its targets statically
 	else {
 		DEBUG(dbgs() << "NOT PTR\n");
-		// TODO: if it's declaration, return value points everywhere, propagate both
-		// can use function to get more information like whether pass by reference
-		// or return by reference. check llvm doc for more detail.
-		if (cd->targets.at(0)->isDeclaration()) return 0;
+		// declarations have no SEG, apply their library summary if there is one
+		if (cd->targets.at(0)->isDeclaration()) return processLibCall(tpts,sn,cd->targets.at(0));
 		targets = cd->targets;
 	}
+	// look up where each argument points once for all targets
+	roots = globalLocations;
+	for (unsigned int i = 0; i < sn->getArgIds()->size(); i++) {
+		if (sn->getArgIds()->at(i)) argpts.push_back(bdd_restrict(*tpts,sn->getStaticData()->at(i)));
+		else                        argpts.push_back(bdd_true());
+		roots |= argpts.back();
+	}
 	DEBUG(dbgs() << "ENUMERATE TARGETS\n");
-	// process all computed targets
-	for (target = targets.begin(); target != targets.end(); ++target)
-		processTarget(tpts,sn,filter,*target);
-	// set outset to inset - filter, then propagate
-	sn->setOutSet(sn->getInSet() - filter);
+	// summarized targets are applied here, the others are entered
+	summaryOut = bdd_false();
+	for (target = targets.begin(); target != targets.end(); ++target) {
+		if (hasSummary(getSEG(*target))) summaryOut |= applySummary(tpts,sn,argpts,*target);
+		else entered.push_back(*target);
+	}
+	// callees only get the part of the inset they can reach
+	filter = bdd_false();
+	if (!entered.empty()) {
+		filter = genFilterSet(sn->getInSet(),roots);
+		DEBUG(dbgs() << "FILTER:\n"; printBDD(LocationCount,Int2Str,filter));
+	}
+	// process all entered targets
+	for (target = entered.begin(); target != entered.end(); ++target)
+		processTarget(tpts,sn,cd,argpts,filter,*target);
+	// remember what known targets have seen
+	cd->lastArgPts = argpts;
+	cd->lastFilter |= filter;
+	// set outset to inset - filter (callees return the rest), then propagate;
+	// keep what targets returned so far, returns only send it once
+	sn->setOutSet((sn->getInSet() - filter) | cd->retOut | summaryOut);
 	propagateAddrTaken(sn);
 	return 0;
 }
@@ -624,7 +648,7 @@ int FlowSensitiveAliasAnalysis::preprocessRet(SEGNode *sn) {
 int FlowSensitiveAliasAnalysis::processRet(bdd *tpts, SEGNode *sn) {
 	std::vector<RetData*>::iterator cit;
 	std::vector<RetData*> *Calls;
-	bdd retpts;
+	bdd retpts, out;
 	// move in to out
 	sn->setOutSet(sn->getInSet());
 	// find out where returned value points
@@ -636,31 +660,40 @@ int FlowSensitiveAliasAnalysis::processRet(bdd *tpts, SEGNode *sn) {
 		retpts = sn->getStaticData()->at(0);
 	}
 	// return if we have no calls
-	if (!Func2Calls.count(sn->getParent()->getFunction())) {
+	if (Func2Calls[sn->getParent()->getIndex()] == NULL) {
 		DEBUG(dbgs() << "RET NO CALLS!\n");
 		return 0;
 	}
 	// get call site list and iterate through it
-	Calls = &Func2Calls.at(sn->getParent()->getFunction())->Calls;
+	Calls = &Func2Calls[sn->getParent()->getIndex()]->Calls;
+	out = sn->getOutSet();
 	for (cit = Calls->begin(); cit != Calls->end(); ++cit) {
 		bool changed = false;
 		RetData *rd = *cit;
 		SEGNode *callInst = rd->callInst;
-		const Function *caller = callInst->getParent()->getFunction();
-		DEBUG(dbgs() << "RET: Call " << *callInst << " from " << caller->getName() << "\n");
-		// append my outset to caller's outset
+		DEBUG(dbgs() << "RET: Call " << *callInst << " from " << callInst->getParent()->getFunction()->getName() << "\n");
+		// append the part of my outset this call hasn't seen to caller's outset
 		// DEBUG(printBDD(LocationCount,Int2Str,sn->getOutSet()));
-		callInst->setOutSet(callInst->getOutSet() | sn->getOutSet());
-		// propagate addr taken and record if worklist changed
-		changed = propagateAddrTaken(callInst) || changed;
-		// if callsite stores a value, propagate on top level
-		if (rd->callStatus != NO_SAVE) {
+		if (out != rd->sentOut) {
+			bdd delta = out - rd->sentOut;
+			rd->sentOut |= out;
+			if (bdd_sat(delta)) {
+				CallData *cd = static_cast<CallData*>(callInst->getExtraData());
+				cd->retOut |= delta;
+				callInst->setOutSet(callInst->getOutSet() | delta);
+				// propagate addr taken and record if worklist changed
+				changed = propagateAddrTaken(callInst) || changed;
+			}
+		}
+		// if callsite stores a value, propagate the new pointees on top level
+		if (rd->callStatus != NO_SAVE && retpts != rd->sentRet) {
 			DEBUG(dbgs() << "RET: Caller saves\n");
-			bdd newpts = rd->saveName & retpts;
+			bdd newpts = rd->saveName & (retpts - rd->sentRet);
+			rd->sentRet |= retpts;
 			changed = propagateTopLevel(tpts,&newpts,callInst) || changed;
-		} else DEBUG(dbgs() << "RET: Caller doesn't save\n");
+		} else DEBUG(dbgs() << "RET: Caller doesn't save or has the value already\n");
 		// if caller's worklist changed, reinsert caller in worklist
-		if (changed) appendIfAbsent<const Function*>(&FuncWorkList,caller);
+		if (changed) queueFunction(callInst->getParent());
 	}
 	return 0;
 }
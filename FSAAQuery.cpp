@@ -0,0 +1,324 @@
+//===- FSAAQuery.cpp - Alias queries over the final points-to sets ---------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Once the solve is done, the top level points-to relation is enumerated
+// once into compressed sparse rows (one sorted pointee array per id) plus a
+// few flags per id, and the BDD library is shut down. Queries are then
+// binary searches and sorted-array intersections.
+//
+// Clients like GVN and LICM ask the same alias questions over and over, so
+// answers are also kept in a bounded cache keyed on the (ordered) pair of
+// value ids, which is dropped whenever the analysis runs again.
+//
+// Tools that ask about every pair of values in a module use the batch
+// queries instead. They turn the rows involved into bitsets over just the
+// pointees those rows mention, and intersect them a vector at a time.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAnalysis.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/DataTypes.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-query"
+
+STATISTIC(AliasQueries,      "Alias queries answered");
+STATISTIC(AliasCacheHits,    "Alias queries answered from the query cache");
+STATISTIC(AliasCacheMisses,  "Alias queries computed on the final points-to sets");
+STATISTIC(BatchQueries,      "Alias queries answered through the batch interface");
+STATISTIC(ConstantMemoryQueries, "Locations found to point only to constant memory");
+STATISTIC(AliasClasses,      "Alias classes of ids with a nonempty points-to row");
+STATISTIC(ClassNoAlias,      "Alias queries answered by different alias classes");
+STATISTIC(RowPairs,          "Pairs in the final top level points-to rows");
+
+// once the cache holds this many answers it starts over
+static cl::opt<unsigned> AliasCacheSize("fsaa-query-cache",
+	cl::desc("Number of alias query answers to keep (0 disables the cache)"),
+	cl::init(1 << 16));
+
+// enumerate TopLevelPTS into the rows in one pass over its satisfying assignments
+void FlowSensitiveAliasAnalysis::materializePointsTo() {
+	std::vector<std::pair<unsigned int,unsigned int> > pairs;
+	std::vector<unsigned int> constants;
+	// an id that points everywhere only needs its flag, not a full row, so
+	// drop every other pointee of those ids before enumerating
+	bdd everywhere = bdd_exist(TopLevelPTS & fdd_ithvar(1,0),fdd_ithset(1));
+	bddRelationPairs((TopLevelPTS - everywhere) | (everywhere & fdd_ithvar(1,0)),pairs);
+	bddDomainValues(constantNames,0,constants);
+	PtsOffsets.assign(LocationCount+1,0);
+	PtsTargets.clear();
+	PtsTargets.reserve(pairs.size());
+	LocFlags.assign(LocationCount,0);
+	// pairs come sorted by id, then by pointee, so rows are filled in order
+	for (unsigned int i = 0; i < pairs.size(); i++) {
+		unsigned int v = pairs[i].first, t = pairs[i].second;
+		if (t == 0) LocFlags[v] |= LOC_EVERYWHERE;
+		else {
+			PtsTargets.push_back(t);
+			PtsOffsets[v+1]++;
+		}
+	}
+	for (unsigned int v = 0; v < LocationCount; v++)
+		PtsOffsets[v+1] += PtsOffsets[v];
+	// constant names are globals and functions, their memory is the next id
+	ConstantLocs.clear();
+	ConstantLocs.resize(LocationCount);
+	for (unsigned int i = 0; i < constants.size(); i++) {
+		LocFlags[constants[i]] |= LOC_CONSTANT;
+		if (constants[i]+1 < LocationCount) ConstantLocs.set(constants[i]+1);
+	}
+	RowPairs = pairs.size();
+	DEBUG(dbgs() << "ROWS: " << pairs.size() << " PAIRS, " << constants.size() << " CONSTANTS\n");
+}
+
+bool FlowSensitiveAliasAnalysis::pointsToConstantMemory(const Location &Loc, bool OrLocal) {
+	unsigned int v = valueId(Loc.Ptr);
+	// unknown or empty points-to sets say nothing, ask the next analysis
+	if (v == 0 || pointsEverywhere(v) || PtsOffsets[v] == PtsOffsets[v+1])
+		return AliasAnalysis::pointsToConstantMemory(Loc,OrLocal);
+	for (unsigned k = PtsOffsets[v]; k < PtsOffsets[v+1]; k++)
+		if (!ConstantLocs.test(PtsTargets[k]))
+			return AliasAnalysis::pointsToConstantMemory(Loc,OrLocal);
+	ConstantMemoryQueries++;
+	return true;
+}
+
+// find the representative of v, halving paths on the way
+static unsigned findClass(std::vector<unsigned> &parent, unsigned v) {
+	while (parent[v] != v) {
+		parent[v] = parent[parent[v]];
+		v = parent[v];
+	}
+	return v;
+}
+
+// ids that point to a common location go in one class
+void FlowSensitiveAliasAnalysis::computeAliasClasses() {
+	std::vector<unsigned> owner(LocationCount,0), rank(LocationCount,0);
+	AliasClass.resize(LocationCount);
+	for (unsigned int v = 0; v < LocationCount; v++)
+		AliasClass[v] = v;
+	for (unsigned int v = 0; v < LocationCount; v++) {
+		// an id that points everywhere would join every class; aliasPrecheck
+		// answers MayAlias for it before the classes are looked at
+		if (pointsEverywhere(v)) continue;
+		for (unsigned k = PtsOffsets[v]; k < PtsOffsets[v+1]; k++) {
+			unsigned t = PtsTargets[k], a, b;
+			// the first id seen pointing to t stands for all of them
+			if (owner[t] == 0) {
+				owner[t] = v + 1;
+				continue;
+			}
+			a = findClass(AliasClass,v);
+			b = findClass(AliasClass,owner[t]-1);
+			if (a == b) continue;
+			if (rank[a] < rank[b]) std::swap(a,b);
+			AliasClass[b] = a;
+			if (rank[a] == rank[b]) rank[a]++;
+		}
+	}
+	// flatten, so a query is two loads and a compare
+	AliasClasses = 0;
+	for (unsigned int v = 0; v < LocationCount; v++) {
+		AliasClass[v] = findClass(AliasClass,v);
+		if (AliasClass[v] == v && PtsOffsets[v] != PtsOffsets[v+1]) AliasClasses++;
+	}
+}
+
+AliasAnalysis::AliasResult FlowSensitiveAliasAnalysis::aliasCheck(unsigned int v1, unsigned int v2) {
+	std::vector<unsigned>::const_iterator i1, e1, i2, e2;
+	assert(v1 < LocationCount && v2 < LocationCount);
+	if (pointsEverywhere(v1) || pointsEverywhere(v2)) return MayAlias;
+	// if the two sorted rows intersect, they may alias; a shared abstract
+	// location doesn't make them must alias
+	i1 = PtsTargets.begin()+PtsOffsets[v1]; e1 = PtsTargets.begin()+PtsOffsets[v1+1];
+	i2 = PtsTargets.begin()+PtsOffsets[v2]; e2 = PtsTargets.begin()+PtsOffsets[v2+1];
+	while (i1 != e1 && i2 != e2) {
+		if (*i1 < *i2) ++i1;
+		else if (*i2 < *i1) ++i2;
+		else return MayAlias;
+	}
+	// otherwise, they don't alias
+	return NoAlias;
+}
+
+AliasAnalysis::AliasResult FlowSensitiveAliasAnalysis::alias(const Location &LocA, const Location &LocB) {
+	DenseMap<std::pair<unsigned,unsigned>, AliasResult>::iterator ci;
+	std::pair<unsigned,unsigned> key;
+	const Value *v1, *v2;
+	unsigned int l1, l2;
+	AliasResult res;
+	AliasQueries++;
+	v1 = LocA.Ptr;
+	v2 = LocB.Ptr;
+	// if they are the same value, they must alias
+	if (v1 == v2) return MustAlias;
+	l1 = valueId(v1);
+	l2 = valueId(v2);
+	// unmapped values share id 0, and casts share the id of their source, so
+	// only answers for mapped pointers are kept; the query is symmetric, so
+	// the smaller id goes first
+	if (l1 == 0 || l2 == 0 || AliasCacheSize == 0 ||
+			!v1->getType()->isPointerTy() || !v2->getType()->isPointerTy())
+		return computeAlias(v1,v2,l1,l2);
+	key = l1 < l2 ? std::make_pair(l1,l2) : std::make_pair(l2,l1);
+	ci = AliasCache.find(key);
+	if (ci != AliasCache.end()) {
+		AliasCacheHits++;
+		return ci->second;
+	}
+	AliasCacheMisses++;
+	res = computeAlias(v1,v2,l1,l2);
+	if (AliasCache.size() >= AliasCacheSize) AliasCache.clear();
+	AliasCache[key] = res;
+	return res;
+}
+
+AliasAnalysis::AliasResult FlowSensitiveAliasAnalysis::computeAlias(const Value *v1, const Value *v2, unsigned int l1, unsigned int l2) {
+	AliasResult res;
+	if (aliasPrecheck(v1,v2,l1,l2,res)) return res;
+	// pointers in different alias classes share no pointee
+	if (AliasClass[l1] != AliasClass[l2]) {
+		ClassNoAlias++;
+		return NoAlias;
+	}
+	// otherwise, check if their points-to sets overlap
+	return aliasCheck(l1,l2);
+}
+
+bool FlowSensitiveAliasAnalysis::aliasPrecheck(const Value *v1, const Value *v2, unsigned int l1, unsigned int l2, AliasResult &res) {
+	const Type *t1, *t2;
+	bool p1, p2, c1, c2;
+	// get these location's types and if they are constants
+	t1 = v1->getType();
+	t2 = v2->getType();
+	p1 = t1->isPtrOrPtrVectorTy() || t1->isVectorTy();
+	p2 = t2->isPtrOrPtrVectorTy() || t2->isVectorTy();
+	c1 = l1 ? isConstantLoc(l1) : false;
+	c2 = l2 ? isConstantLoc(l2) : false;
+	res = MayAlias;
+	// if they are both constants or not pointers, they won't alias (they are different)
+	if ((c1 || !p1) && (c2 || !p2)) { res = NoAlias; return true; }
+	// if everything -> everything, they may alias
+	if (pointsEverywhere(0)) return true;
+	// if the two locations are not mapped, they won't alias (they are different)
+	if (l1 == 0 && l2 == 0) { res = NoAlias; return true; }
+	// if either value points everywhere, they may alias
+	else if (l1 != 0 && pointsEverywhere(l1)) return true;
+	else if (l2 != 0 && pointsEverywhere(l2)) return true;
+	// if one is a constant or pointer, check if the other points to it
+	if ((c1 || !p1) && pointsToLoc(l2,l1)) return true;
+	if ((c2 || !p2) && pointsToLoc(l1,l2)) return true;
+	return false;
+}
+
+namespace {
+/// RowBitsets - the points-to rows of some ids as bitsets over only the
+/// pointees those rows mention; every bitset is a whole number of 128 bit
+/// vectors long, so the intersection kernel needs no tail loop
+class RowBitsets {
+	std::vector<uint64_t> Bits;
+	DenseMap<unsigned,unsigned> Slot;
+	unsigned Words;
+
+public:
+	RowBitsets(const std::vector<unsigned> &offsets, const std::vector<unsigned> &targets,
+			const std::vector<unsigned> &ids) {
+		std::vector<unsigned> pointees;
+		// number the pointees the rows of ids mention densely
+		for (unsigned i = 0; i < ids.size(); i++)
+			pointees.insert(pointees.end(),targets.begin()+offsets[ids[i]],targets.begin()+offsets[ids[i]+1]);
+		std::sort(pointees.begin(),pointees.end());
+		pointees.erase(std::unique(pointees.begin(),pointees.end()),pointees.end());
+		Words = (pointees.size() + 127) / 128 * 2;
+		Bits.assign(ids.size() * Words,0);
+		for (unsigned i = 0; i < ids.size(); i++) {
+			uint64_t *row = &Bits[0] + i * Words;
+			Slot[ids[i]] = i;
+			for (unsigned k = offsets[ids[i]]; k < offsets[ids[i]+1]; k++) {
+				unsigned b = std::lower_bound(pointees.begin(),pointees.end(),targets[k]) - pointees.begin();
+				row[b / 64] |= (uint64_t)1 << (b % 64);
+			}
+		}
+	}
+
+	/// intersect - do the rows of ids l1 and l2 share a pointee?
+	bool intersect(unsigned l1, unsigned l2) {
+		const uint64_t *a, *b;
+		if (Words == 0) return false;
+		a = &Bits[0] + Slot.lookup(l1) * Words;
+		b = &Bits[0] + Slot.lookup(l2) * Words;
+#ifdef __SSE2__
+		const __m128i zero = _mm_setzero_si128();
+		for (unsigned i = 0; i < Words; i += 2) {
+			__m128i x = _mm_and_si128(_mm_loadu_si128((const __m128i*)(a+i)),_mm_loadu_si128((const __m128i*)(b+i)));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(x,zero)) != 0xFFFF) return true;
+		}
+#else
+		for (unsigned i = 0; i < Words; i++)
+			if (a[i] & b[i]) return true;
+#endif
+		return false;
+	}
+};
+}
+
+void FlowSensitiveAliasAnalysis::aliasBatch(const std::vector<std::pair<const Value*,const Value*> > &pairs,
+		std::vector<AliasResult> &results) {
+	std::vector<std::pair<unsigned,unsigned> > pendingIds;
+	std::vector<unsigned> pending, ids;
+	results.assign(pairs.size(),MayAlias);
+	BatchQueries += pairs.size();
+	// answer what the flags can, remember which rows the rest need
+	for (unsigned i = 0; i < pairs.size(); i++) {
+		const Value *v1 = pairs[i].first, *v2 = pairs[i].second;
+		unsigned int l1, l2;
+		if (v1 == v2) { results[i] = MustAlias; continue; }
+		l1 = valueId(v1);
+		l2 = valueId(v2);
+		if (aliasPrecheck(v1,v2,l1,l2,results[i])) continue;
+		pending.push_back(i);
+		pendingIds.push_back(std::make_pair(l1,l2));
+		ids.push_back(l1);
+		ids.push_back(l2);
+	}
+	if (pending.empty()) return;
+	std::sort(ids.begin(),ids.end());
+	ids.erase(std::unique(ids.begin(),ids.end()),ids.end());
+	RowBitsets rows(PtsOffsets,PtsTargets,ids);
+	for (unsigned i = 0; i < pending.size(); i++) {
+		unsigned l1 = pendingIds[i].first, l2 = pendingIds[i].second;
+		results[pending[i]] = AliasClass[l1] == AliasClass[l2] && rows.intersect(l1,l2) ? MayAlias : NoAlias;
+	}
+}
+
+void FlowSensitiveAliasAnalysis::aliasMatrix(const std::vector<const Value*> &values, std::vector<AliasResult> &matrix) {
+	unsigned n = values.size();
+	std::vector<unsigned> l(n), ids;
+	matrix.assign(n * n,MustAlias);
+	BatchQueries += n * n;
+	for (unsigned i = 0; i < n; i++)
+		l[i] = valueId(values[i]);
+	ids = l;
+	std::sort(ids.begin(),ids.end());
+	ids.erase(std::unique(ids.begin(),ids.end()),ids.end());
+	RowBitsets rows(PtsOffsets,PtsTargets,ids);
+	// the relation is symmetric, compute the upper triangle and mirror it
+	for (unsigned i = 0; i < n; i++) {
+		for (unsigned j = i+1; j < n; j++) {
+			AliasResult res = MustAlias;
+			if (values[i] != values[j] && !aliasPrecheck(values[i],values[j],l[i],l[j],res))
+				res = AliasClass[l[i]] == AliasClass[l[j]] && rows.intersect(l[i],l[j]) ? MayAlias : NoAlias;
+			matrix[i*n+j] = matrix[j*n+i] = res;
+		}
+	}
+}
@@ -0,0 +1,325 @@
+//===- FSAAStats.cpp - Per-phase instrumentation of the analysis -----------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAStats.h"
+#include "SEG.h"
+#include "bdd.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <time.h>
+#include <sys/resource.h>
+
+using namespace llvm;
+
+// peak resident set size of the process so far, in KB
+static long peakRSS() {
+	struct rusage ru;
+	if (getrusage(RUSAGE_SELF,&ru) != 0) return 0;
+	return ru.ru_maxrss;
+}
+
+// write s as a JSON string literal
+static void writeString(raw_ostream &os, const std::string &s) {
+	os << '"';
+	for (unsigned i = 0; i < s.size(); i++) {
+		unsigned char c = s[i];
+		if (c == '"' || c == '\\') os << '\\' << c;
+		else if (c < 0x20) os << "\\u00" << hexdigit(c >> 4, true) << hexdigit(c & 15, true);
+		else os << c;
+	}
+	os << '"';
+}
+
+// the most nodes in use since the last resetBDDPeak; before a garbage
+// collection dead nodes still count, so that is where the table peaks
+static long BDDPeak = -1;
+static bddgbchandler ChainedGbcHandler = NULL;
+
+static void peakGbcHandler(int pre, bddGbcStat *s) {
+	if (pre) BDDPeak = std::max(BDDPeak,(long)bdd_getnodenum());
+	if (ChainedGbcHandler != NULL) ChainedGbcHandler(pre,s);
+}
+
+// start a new high mark from the nodes in use now, hooking the collector
+// the first time the library is seen running (bdd_init resets the hook)
+static void resetBDDPeak() {
+	if (!bdd_isrunning()) {
+		BDDPeak = -1;
+		return;
+	}
+	bddgbchandler h = bdd_gbc_hook(peakGbcHandler);
+	if (h != peakGbcHandler) ChainedGbcHandler = h;
+	BDDPeak = bdd_getnodenum();
+}
+
+void PhaseRecorder::reset(bool enabled) {
+	Enabled = enabled;
+	Phases.clear();
+	CurName.clear();
+}
+
+void PhaseRecorder::begin(const char *name, int round) {
+	if (!Enabled) return;
+	assert(CurName.empty() && "phases don't nest");
+	CurName = name;
+	CurRound = round;
+	CurPeakRSS = peakRSS();
+	resetBDDPeak();
+	CurStart = TimeRecord::getCurrentTime(true);
+}
+
+void PhaseRecorder::end() {
+	if (!Enabled) return;
+	TimeRecord t = TimeRecord::getCurrentTime(false);
+	Phase p;
+	assert(!CurName.empty() && "no phase to end");
+	t -= CurStart;
+	p.Name = CurName;
+	p.Round = CurRound;
+	p.Wall = t.getWallTime();
+	p.User = t.getUserTime();
+	p.System = t.getSystemTime();
+	p.PeakRSS = peakRSS();
+	p.PeakRSSGrowth = p.PeakRSS - CurPeakRSS;
+	// the library is only up between pointsToInit and pointsToFinalize
+	p.BDDNodes = bdd_isrunning() ? bdd_getnodenum() : -1;
+	p.BDDPeakNodes = std::max(BDDPeak,p.BDDNodes);
+	p.BDDAlloc = bdd_isrunning() ? bdd_getallocnum() : -1;
+	Phases.push_back(p);
+	CurName.clear();
+}
+
+bool PhaseRecorder::writeJSON(const std::string &file, const std::string &module, std::string &error) const {
+	double wall = 0, user = 0, system = 0;
+	raw_fd_ostream os(file.c_str(),error,sys::fs::F_None);
+	if (!error.empty()) return false;
+	os << "{\n  \"module\": ";
+	writeString(os,module);
+	os << ",\n  \"phases\": [";
+	for (unsigned i = 0; i < Phases.size(); i++) {
+		const Phase &p = Phases[i];
+		os << (i ? ",\n" : "\n") << "    {\"name\": ";
+		writeString(os,p.Name);
+		if (p.Round >= 0) os << ", \"round\": " << p.Round;
+		os << ", \"wall\": " << format("%.6f",p.Wall)
+		   << ", \"user\": " << format("%.6f",p.User)
+		   << ", \"system\": " << format("%.6f",p.System)
+		   << ", \"peak_rss_kb\": " << p.PeakRSS
+		   << ", \"peak_rss_growth_kb\": " << p.PeakRSSGrowth;
+		if (p.BDDNodes >= 0)
+			os << ", \"bdd_nodes\": " << p.BDDNodes << ", \"bdd_peak_nodes\": " << p.BDDPeakNodes
+			   << ", \"bdd_allocated\": " << p.BDDAlloc;
+		os << "}";
+		wall += p.Wall;
+		user += p.User;
+		system += p.System;
+	}
+	os << "\n  ],\n  \"total\": {\"wall\": " << format("%.6f",wall)
+	   << ", \"user\": " << format("%.6f",user)
+	   << ", \"system\": " << format("%.6f",system)
+	   << ", \"peak_rss_kb\": " << peakRSS() << "}\n}\n";
+	return true;
+}
+
+// a monotonic clock in nanoseconds; getrusage (TimeRecord) is too slow to
+// call around every transfer function
+static uint64_t nowNanos() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// BDD nodes produced since the library started
+static long producedNodes() {
+	bddStat st;
+	bdd_stats(&st);
+	return st.produced;
+}
+
+// order (key, counter) pairs by time, hottest first
+template <typename K>
+static bool hotter(const std::pair<K,TransferProfiler::Counter> &a, const std::pair<K,TransferProfiler::Counter> &b) {
+	return a.second.Nanos > b.second.Nanos;
+}
+
+static void printCounter(raw_ostream &os, const TransferProfiler::Counter &c, uint64_t total) {
+	os << format("%10llu %12.3f ms %6.2f%% %12llu nodes", (unsigned long long)c.Count,
+		c.Nanos / 1e6, total ? 100.0 * c.Nanos / total : 0.0, (unsigned long long)c.Nodes);
+}
+
+void TransferProfiler::reset(bool enabled, unsigned functions) {
+	Enabled = enabled;
+	ByOpcode.clear();
+	ByNode.clear();
+	ByFunction.assign(enabled ? functions : 0,Counter());
+}
+
+void TransferProfiler::begin() {
+	if (!Enabled) return;
+	StartNodes = producedNodes();
+	StartNanos = nowNanos();
+}
+
+void TransferProfiler::end(const char *opcode, unsigned fi, SEGNode *sn) {
+	if (!Enabled) return;
+	uint64_t nanos = nowNanos() - StartNanos;
+	uint64_t nodes = producedNodes() - StartNodes;
+	Counter *cs[3] = { &ByOpcode[opcode], &ByFunction[fi], &ByNode[sn] };
+	for (unsigned i = 0; i < 3; i++) {
+		cs[i]->Count++;
+		cs[i]->Nanos += nanos;
+		cs[i]->Nodes += nodes;
+	}
+}
+
+void TransferProfiler::print(raw_ostream &os, unsigned top, const std::vector<SEG*> &segs) const {
+	std::vector<std::pair<const char*,Counter> > ops(ByOpcode.begin(),ByOpcode.end());
+	std::vector<std::pair<unsigned,Counter> > funcs;
+	std::vector<std::pair<SEGNode*,Counter> > nodes(ByNode.begin(),ByNode.end());
+	uint64_t total = 0;
+	if (!Enabled) return;
+	for (unsigned i = 0; i < ByFunction.size(); i++) {
+		total += ByFunction[i].Nanos;
+		if (ByFunction[i].Count) funcs.push_back(std::make_pair(i,ByFunction[i]));
+	}
+	std::sort(ops.begin(),ops.end(),hotter<const char*>);
+	std::sort(funcs.begin(),funcs.end(),hotter<unsigned>);
+	std::sort(nodes.begin(),nodes.end(),hotter<SEGNode*>);
+	os << "TRANSFER FUNCTIONS BY OPCODE:\n";
+	for (unsigned i = 0; i < ops.size(); i++) {
+		os << format("  %-16s", ops[i].first);
+		printCounter(os,ops[i].second,total);
+		os << "\n";
+	}
+	os << "HOTTEST FUNCTIONS:\n";
+	for (unsigned i = 0; i < funcs.size() && i < top; i++) {
+		os << "  ";
+		printCounter(os,funcs[i].second,total);
+		os << "  " << segs[funcs[i].first]->getFunction()->getName() << "\n";
+	}
+	os << "HOTTEST NODES:\n";
+	for (unsigned i = 0; i < nodes.size() && i < top; i++) {
+		SEGNode *sn = nodes[i].first;
+		os << "  ";
+		printCounter(os,nodes[i].second,total);
+		os << "  " << sn->getParent()->getFunction()->getName() << ":";
+		if (sn->getInstruction() != NULL) os << *sn->getInstruction() << "\n";
+		else os << " " << *sn << "\n";
+	}
+}
+
+bool WorklistTrace::open(const std::string &file, const std::vector<SEG*> &segs, std::string &error) {
+	FSAATraceHeader h;
+	std::string names;
+	close();
+	Nodes.clear();
+	Records = 0;
+	Current = FSAA_TRACE_NO_CAUSE;
+	// number nodes by their position in their SEG, and name functions
+	for (unsigned i = 0; i < segs.size(); i++) {
+		uint32_t n = 0;
+		for (SEG::iterator sni = segs[i]->begin(), sne = segs[i]->end(); sni != sne; ++sni) {
+			NodeInfo info = { n++, FSAA_TRACE_NO_CAUSE };
+			Nodes[&*sni] = info;
+		}
+		names += segs[i]->getFunction()->getName();
+		names += '\0';
+	}
+	names += "(none)";
+	names += '\0';
+	for (unsigned op = 1; op < Instruction::OtherOpsEnd; op++) {
+		names += Instruction::getOpcodeName(op);
+		names += '\0';
+	}
+	while (names.size() % 8) names += '\0';
+	Out = new raw_fd_ostream(file.c_str(),error,sys::fs::F_Binary);
+	if (!error.empty()) {
+		delete Out;
+		Out = NULL;
+		return false;
+	}
+	memset(&h,0,sizeof(h));
+	strncpy(h.Magic,FSAA_TRACE_MAGIC,sizeof(h.Magic));
+	h.Version = FSAA_TRACE_VERSION;
+	h.ByteOrder = FSAA_TRACE_BYTEORDER;
+	h.FunctionCount = segs.size();
+	h.OpcodeCount = Instruction::OtherOpsEnd;
+	h.NamesSize = names.size();
+	Out->write((const char*)&h,sizeof(h));
+	Out->write(names.data(),names.size());
+	StartNanos = nowNanos();
+	return true;
+}
+
+void WorklistTrace::close() {
+	if (Out == NULL) return;
+	delete Out;
+	Out = NULL;
+	Nodes.clear();
+}
+
+void WorklistTrace::write(const FSAATraceRecord &r) {
+	Out->write((const char*)&r,sizeof(r));
+	Records++;
+}
+
+void WorklistTrace::round(int rnd) {
+	FSAATraceRecord r;
+	if (Out == NULL) return;
+	memset(&r,0,sizeof(r));
+	r.Nanos = nowNanos() - StartNanos;
+	r.Kind = FSAA_TRACE_ROUND;
+	r.Node = rnd;
+	r.Cause = FSAA_TRACE_NO_CAUSE;
+	write(r);
+}
+
+void WorklistTrace::popFunction(unsigned fi) {
+	FSAATraceRecord r;
+	if (Out == NULL) return;
+	memset(&r,0,sizeof(r));
+	r.Nanos = nowNanos() - StartNanos;
+	r.Kind = FSAA_TRACE_FUNCTION;
+	r.Function = fi;
+	r.Cause = FSAA_TRACE_NO_CAUSE;
+	write(r);
+}
+
+void WorklistTrace::beginNode(SEGNode *sn, unsigned opcode, unsigned flags) {
+	FSAATraceRecord &r = CurRecord;
+	if (Out == NULL) return;
+	NodeInfo &info = Nodes[sn];
+	memset(&r,0,sizeof(r));
+	r.Nanos = nowNanos() - StartNanos;
+	r.Kind = FSAA_TRACE_NODE;
+	r.Function = sn->getParent()->getIndex();
+	r.Node = info.Number;
+	r.Cause = info.Cause;
+	r.Opcode = opcode;
+	r.Flags = flags;
+	// whatever this node queues, it queues as record number Records
+	info.Cause = FSAA_TRACE_NO_CAUSE;
+	Current = Records;
+	CurQueued = 0;
+}
+
+void WorklistTrace::endNode(bool topChanged, bool outChanged, unsigned outNodes) {
+	if (Out == NULL) return;
+	CurRecord.Queued = CurQueued;
+	CurRecord.OutNodes = outChanged ? outNodes : 0;
+	if (topChanged) CurRecord.Flags |= FSAA_TRACE_TOP_CHANGED;
+	if (outChanged) CurRecord.Flags |= FSAA_TRACE_OUT_CHANGED;
+	write(CurRecord);
+	Current = FSAA_TRACE_NO_CAUSE;
+}
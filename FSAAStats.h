@@ -0,0 +1,175 @@
+//===- FSAAStats.h - Per-phase instrumentation of the analysis -------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// PhaseRecorder times the phases of runOnModule and snapshots the peak RSS
+// and BDD node counts at the end of each one; -fsaa-phase-report=<file>
+// writes them out as JSON. The node table is fullest right before a garbage
+// collection, so while recording it also hooks the collector to find the
+// most nodes in use during each phase. When no report is asked for,
+// begin/end do nothing.
+//
+// TransferProfiler counts, times and measures the BDD nodes produced by
+// every transfer function doAnalysis runs, by opcode, by function and by
+// SEG node, and prints the hottest of each (-fsaa-profile).
+//
+// WorklistTrace writes a record for every worklist pop to a binary file
+// (-fsaa-trace=<file>, layout in FSAATraceFormat.h) for Trace/fsaa-trace to
+// summarize offline.
+//
+//===----------------------------------------------------------------------===//
+#ifndef FSAA_STATS_H
+#define FSAA_STATS_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Timer.h"
+#include "FSAATraceFormat.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class PhaseRecorder {
+public:
+	/// Phase - what one phase cost, and where memory stood when it ended
+	struct Phase {
+		std::string Name;
+		int Round;              // doAnalysis round, -1 for one-off phases
+		double Wall, User, System;
+		long PeakRSS;           // KB, for the whole process
+		long PeakRSSGrowth;     // KB the peak grew by during the phase
+		long BDDNodes;          // live nodes, -1 if the library is not running
+		long BDDPeakNodes;      // most nodes in use during the phase, -1 likewise
+		long BDDAlloc;          // allocated nodes, -1 likewise; the table never
+		                        // shrinks, so this is also its peak so far
+	};
+
+private:
+	bool Enabled;
+	std::vector<Phase> Phases;
+
+	/// the phase in progress
+	std::string CurName;
+	int CurRound;
+	TimeRecord CurStart;
+	long CurPeakRSS;
+
+public:
+	PhaseRecorder() : Enabled(false), CurRound(-1), CurPeakRSS(0) {}
+
+	/// reset - forget earlier phases; record from now on only if enabled
+	void reset(bool enabled);
+	bool enabled() const { return Enabled; }
+
+	/// begin/end - bracket a phase; phases don't nest
+	void begin(const char *name, int round = -1);
+	void end();
+
+	/// the phases recorded since reset, in order
+	unsigned size() const { return Phases.size(); }
+	const Phase &phase(unsigned i) const { return Phases[i]; }
+
+	/// writeJSON - write every phase recorded since reset to file; false
+	/// (and error says why) if the file cannot be written
+	bool writeJSON(const std::string &file, const std::string &module, std::string &error) const;
+};
+
+class SEG;
+class SEGNode;
+class raw_ostream;
+
+class TransferProfiler {
+public:
+	/// Counter - what the transfer functions under one key cost
+	struct Counter {
+		uint64_t Count;
+		uint64_t Nanos;
+		uint64_t Nodes;         // BDD nodes produced
+		Counter() : Count(0), Nanos(0), Nodes(0) {}
+	};
+
+private:
+	bool Enabled;
+	/// ByOpcode - keyed on the opcode name (getOpcodeName's static strings),
+	/// or on "preserve"/"undef" for nodes that are not dispatched on opcode
+	DenseMap<const char*,Counter> ByOpcode;
+	/// ByFunction - by SEG index
+	std::vector<Counter> ByFunction;
+	DenseMap<SEGNode*,Counter> ByNode;
+
+	/// the transfer function in progress
+	uint64_t StartNanos;
+	long StartNodes;
+
+public:
+	TransferProfiler() : Enabled(false), StartNanos(0), StartNodes(0) {}
+
+	/// reset - forget earlier counts; profile from now on only if enabled
+	void reset(bool enabled, unsigned functions);
+	bool enabled() const { return Enabled; }
+
+	/// begin/end - bracket one transfer function on sn, in function fi
+	void begin();
+	void end(const char *opcode, unsigned fi, SEGNode *sn);
+
+	/// print - the totals by opcode, then the top hottest functions and
+	/// nodes by time (segs gives their names, so print before clean)
+	void print(raw_ostream &os, unsigned top, const std::vector<SEG*> &segs) const;
+};
+
+class raw_fd_ostream;
+
+class WorklistTrace {
+private:
+	/// NodeInfo - a node's position in its SEG, and the record that queued it
+	struct NodeInfo {
+		uint32_t Number;
+		uint32_t Cause;
+	};
+
+	raw_fd_ostream *Out;
+	DenseMap<SEGNode*,NodeInfo> Nodes;
+	uint64_t StartNanos;
+	/// Records - records written so far
+	uint32_t Records;
+
+	/// the node pop in progress (FSAA_TRACE_NO_CAUSE if none)
+	uint32_t Current;
+	uint32_t CurQueued;
+	FSAATraceRecord CurRecord;
+
+	void write(const FSAATraceRecord &r);
+
+public:
+	WorklistTrace() : Out(NULL), StartNanos(0), Records(0), Current(FSAA_TRACE_NO_CAUSE), CurQueued(0) {}
+	~WorklistTrace() { close(); }
+
+	/// open - start a trace of the functions in segs; false (and error says
+	/// why) if file cannot be written
+	bool open(const std::string &file, const std::vector<SEG*> &segs, std::string &error);
+	void close();
+	bool enabled() const { return Out != NULL; }
+
+	void round(int rnd);
+	void popFunction(unsigned fi);
+
+	/// beginNode/endNode - bracket the transfer function of a popped node
+	void beginNode(SEGNode *sn, unsigned opcode, unsigned flags);
+	void endNode(bool topChanged, bool outChanged, unsigned outNodes);
+
+	/// queued - sn was appended to a worklist, by the node in progress if any
+	void queued(SEGNode *sn) {
+		DenseMap<SEGNode*,NodeInfo>::iterator ni = Nodes.find(sn);
+		if (ni != Nodes.end()) ni->second.Cause = Current;
+		CurQueued++;
+	}
+};
+
+} // end namespace llvm
+
+#endif /* FSAA_STATS_H */
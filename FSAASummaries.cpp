@@ -0,0 +1,291 @@
+//===- FSAASummaries.cpp - Bottom-up transfer summaries for calls ---------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// With -fsaa-summaries, the call graph is walked bottom-up one SCC at a
+// time. An SCC whose calls all stay in summarized code (library calls with
+// a summary, and defined functions that have a summary themselves) gets a
+// transfer summary: the steps its instructions take on value ids, plus the
+// steps of everything it calls, with formals bound to the actuals and
+// returns to the call values. The summary is a relation over the callee's
+// formals, the globals and its return values, shared by the whole SCC.
+//
+// A call applies it without entering the callee's SEG: it binds the
+// formals to this call's arguments, runs the steps against the caller's
+// top level and address-taken sets until nothing changes, and takes the
+// returned pointees and the resulting memory from there. Each call solves
+// its own instance, so contexts never mix through a summarized callee. The
+// steps are solved flow-insensitively: stores inside a summary are weak.
+//
+// SCCs with indirect calls, with calls to declarations without a summary or
+// to functions without one, or with more than -fsaa-summary-limit steps,
+// keep the SEG-based propagation.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAnalysis.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/CommandLine.h"
+
+#undef  DEBUG_TYPE
+#define DEBUG_TYPE "fsaa-summary"
+
+STATISTIC(SummarizedFunctions, "Functions with a transfer summary");
+STATISTIC(SummaryApplications, "Call visits handled by a transfer summary");
+
+// every call solves the whole summary again, so past some size the SEG of
+// the callee is cheaper
+static cl::opt<unsigned> SummaryLimit("fsaa-summary-limit",
+	cl::desc("Maximum number of steps in a function summary, callees included"),
+	cl::init(2000));
+
+static void addOp(std::vector<SummaryOp> &ops, unsigned int kind, unsigned int dst, unsigned int src) {
+	SummaryOp op = { kind, dst, src };
+	ops.push_back(op);
+}
+
+// append the steps of f's own instructions to ops, and the summaries its
+// calls use to callees; false if some call can't be summarized
+bool FlowSensitiveAliasAnalysis::summarizeFunction(const Function *f, std::vector<SummaryOp> &ops, std::set<int> &callees) {
+	SEG *seg = getSEG(f);
+	for (SEG::iterator sni=seg->begin(), sne=seg->end(); sni!=sne; ++sni) {
+		SEGNode *sn = &*sni;
+		if (!sn->isnPnode()) continue;
+		const Instruction *i = sn->getInstruction();
+		unsigned int id = valueId(i);
+		// the same cases setupAnalysis preprocesses
+		if (isa<AllocaInst>(i)) {
+			addOp(ops,SUMMARY_ALLOC,id,id+1);
+		} else if (isa<PHINode>(i)) {
+			for (User::const_op_iterator oit = i->op_begin(); oit != i->op_end(); ++oit)
+				addOp(ops,SUMMARY_COPY,id,valueId(oit->get()));
+		} else if (const LoadInst *ld = dyn_cast<LoadInst>(i)) {
+			unsigned int p = valueId(ld->getPointerOperand());
+			if (p) addOp(ops,SUMMARY_LOAD,id,p);
+			else   addOp(ops,SUMMARY_ALLOC,id,0);
+		} else if (const StoreInst *sr = dyn_cast<StoreInst>(i)) {
+			addOp(ops,SUMMARY_STORE,valueId(sr->getPointerOperand()),valueId(sr->getValueOperand()));
+		} else if (isa<CallInst>(i) || isa<InvokeInst>(i)) {
+			ImmutableCallSite cs(i);
+			const Function *callee = cs.getCalledFunction();
+			// indirect calls need the SEG to find their targets
+			if (callee == NULL) return false;
+			if (callee->isDeclaration()) {
+				std::map<const Function*,LibCallSummary>::iterator li = LibSummaries.find(callee);
+				bool heapSite = HeapSites.count(i) != 0;
+				// without a summary, the declaration may do anything
+				if (li == LibSummaries.end() && !heapSite) return false;
+				// the same effects processLibCall applies
+				if (li != LibSummaries.end() && (li->second.flags & LIBCALL_COPY))
+					addOp(ops,SUMMARY_MEMCOPY,valueId(cs.getArgument(li->second.dstArg)),
+						valueId(cs.getArgument(li->second.srcArg)));
+				if (!i->getType()->isPointerTy() || id == 0) continue;
+				if (heapSite) addOp(ops,SUMMARY_ALLOC,id,id+1);
+				else if (li->second.flags & LIBCALL_ALLOC) addOp(ops,SUMMARY_ALLOC,id,HeapId);
+				if (li != LibSummaries.end() && (li->second.flags & LIBCALL_RETARG))
+					addOp(ops,SUMMARY_COPY,id,valueId(cs.getArgument(li->second.retArg)));
+				continue;
+			}
+			unsigned int ci = getSEG(callee)->getIndex();
+			if (SummaryOf[ci] < 0) return false;
+			callees.insert(SummaryOf[ci]);
+			// bind the formals to the actuals, the call to the returns
+			unsigned int n = 0;
+			for (Function::const_arg_iterator ai=callee->arg_begin(), ae=callee->arg_end(); ai!=ae && n < cs.arg_size(); ++ai, ++n)
+				addOp(ops,SUMMARY_COPY,Value2Int.at(&*ai),valueId(cs.getArgument(n)));
+			if (id == 0) continue;
+			for (unsigned int k = 0; k < SummaryReturns[ci].size(); k++)
+				addOp(ops,SUMMARY_COPY,id,SummaryReturns[ci][k]);
+		} else if (isa<CastInst>(i) || isa<GetElementPtrInst>(i)) {
+#ifndef ENABLE_OPT_1
+			for (User::const_op_iterator oit = i->op_begin(); oit != i->op_end(); ++oit)
+				addOp(ops,SUMMARY_COPY,id,valueId(oit->get()));
+#else
+			// other single copies share the id of their source
+			if (sn->undefSource()) addOp(ops,SUMMARY_ALLOC,id,0);
+#endif
+		}
+		// returns are in SummaryReturns
+	}
+	return true;
+}
+
+// summarize the SCCs of the call graph bottom-up; a summary includes the
+// steps of the summaries it calls, each one once
+void FlowSensitiveAliasAnalysis::initializeSummaries(CallGraph *cg) {
+	std::vector<std::vector<SummaryOp> > own;          // steps of each summary's own functions
+	std::vector<std::vector<int> > closure;            // summaries each one includes, itself too
+	std::vector<std::vector<const Function*> > funcs;  // functions of each summary
+	Summaries.clear();
+	SummaryOf.assign(Func2SEG.size(),-1);
+	SummaryReturns.assign(Func2SEG.size(),std::vector<unsigned>());
+	SummaryOnly.assign(Func2SEG.size(),false);
+	// what every defined function returns, for the calls to bind
+	for (unsigned int k = 0; k < Func2SEG.size(); k++) {
+		const Function *f = Func2SEG[k]->getFunction();
+		if (f->isDeclaration()) continue;
+		for (Function::const_iterator bi=f->begin(), be=f->end(); bi!=be; ++bi)
+			if (const ReturnInst *r = dyn_cast<ReturnInst>(bi->getTerminator()))
+				SummaryReturns[k].push_back(valueId(r->getReturnValue()));
+	}
+	for (scc_iterator<CallGraph*> si = scc_begin(cg), se = scc_end(cg); si != se; ++si) {
+		std::vector<CallGraphNode*> &scc = *si;
+		std::vector<const Function*> fs;
+		std::vector<SummaryOp> ops;
+		std::set<int> callees, included;
+		int index = Summaries.size();
+		size_t size;
+		bool ok = true;
+		for (unsigned int n = 0; n < scc.size(); n++) {
+			const Function *f = scc[n]->getFunction();
+			if (f != NULL && !f->isDeclaration()) fs.push_back(f);
+		}
+		if (fs.empty()) continue;
+		// calls inside the SCC use the summary being built
+		for (unsigned int n = 0; n < fs.size(); n++)
+			SummaryOf[getSEG(fs[n])->getIndex()] = index;
+		for (unsigned int n = 0; ok && n < fs.size(); n++)
+			ok = summarizeFunction(fs[n],ops,callees);
+		included.insert(index);
+		for (std::set<int>::iterator ci = callees.begin(); ci != callees.end(); ++ci)
+			if (*ci != index) included.insert(closure[*ci].begin(),closure[*ci].end());
+		size = ops.size();
+		for (std::set<int>::iterator ci = included.begin(); ci != included.end(); ++ci)
+			if (*ci != index) size += own[*ci].size();
+		if (!ok || size > SummaryLimit) {
+			for (unsigned int n = 0; n < fs.size(); n++) {
+				SummaryOf[getSEG(fs[n])->getIndex()] = -1;
+				DEBUG(dbgs() << "NO SUMMARY: " << fs[n]->getName() << "\n");
+			}
+			continue;
+		}
+		own.push_back(ops);
+		closure.push_back(std::vector<int>(included.begin(),included.end()));
+		funcs.push_back(fs);
+		Summaries.push_back(FuncSummary());
+		FuncSummary &sum = Summaries.back();
+		sum.Locals = bdd_false();
+		sum.Loads = bdd_false();
+		for (std::set<int>::iterator ci = included.begin(); ci != included.end(); ++ci) {
+			sum.Ops.insert(sum.Ops.end(),own[*ci].begin(),own[*ci].end());
+			for (unsigned int n = 0; n < funcs[*ci].size(); n++)
+				for (Function::const_arg_iterator ai=funcs[*ci][n]->arg_begin(), ae=funcs[*ci][n]->arg_end(); ai!=ae; ++ai)
+					sum.Locals |= fdd_ithvar(0,Value2Int.at(&*ai));
+		}
+		for (unsigned int k = 0; k < sum.Ops.size(); k++) {
+			const SummaryOp &op = sum.Ops[k];
+			if (op.Kind == SUMMARY_STORE || op.Kind == SUMMARY_MEMCOPY) continue;
+			sum.Locals |= fdd_ithvar(0,op.Dst);
+			if (op.Kind == SUMMARY_LOAD) sum.Loads |= fdd_ithvar(0,op.Dst);
+		}
+		SummaryLoads |= sum.Loads;
+		SummarizedFunctions += fs.size();
+		for (unsigned int n = 0; n < fs.size(); n++)
+			DEBUG(dbgs() << "SUMMARY: " << fs[n]->getName() << " STEPS " << sum.Ops.size() << "\n");
+	}
+	// every call from outside its SCC applies the summary, so such a
+	// function's SEG would only ever see its placeholder arguments
+	for (CallGraph::iterator cit = cg->begin(); cit != cg->end(); ++cit) {
+		const Function *caller = cit->second->getFunction();
+		if (caller == NULL || caller->isDeclaration()) continue;
+		int callerSummary = SummaryOf[getSEG(caller)->getIndex()];
+		for (CallGraphNode::iterator nit = cit->second->begin(); nit != cit->second->end(); ++nit) {
+			const Function *callee = nit->second->getFunction();
+			Value *v = nit->first;
+			if (v == NULL || callee == NULL || callee->isDeclaration()) continue;
+			unsigned int ci = getSEG(callee)->getIndex();
+			if (SummaryOf[ci] >= 0 && SummaryOf[ci] != callerSummary) SummaryOnly[ci] = true;
+		}
+	}
+}
+
+// run the steps of fs on the top level set top and the address-taken set
+// mem until neither changes; the steps have no order, so stores are weak
+void FlowSensitiveAliasAnalysis::solveSummary(const FuncSummary &fs, bdd &top, bdd &mem) {
+	bdd everywhere = fdd_ithvar(1,0);
+	bool changed = true;
+	while (changed) {
+		bdd oldtop = top, oldmem = mem;
+		for (unsigned int k = 0; k < fs.Ops.size(); k++) {
+			const SummaryOp &op = fs.Ops[k];
+			bdd dst = fdd_ithvar(0,op.Dst), topx, topy, contents;
+			switch (op.Kind) {
+			case SUMMARY_ALLOC:
+				top |= dst & fdd_ithvar(1,op.Src);
+				break;
+			case SUMMARY_COPY:
+				top |= dst & (op.Src ? bdd_restrict(top,fdd_ithvar(0,op.Src)) : everywhere);
+				break;
+			case SUMMARY_LOAD:
+				// as in processLoad, a pointer that points everywhere loads everything
+				topy = out2in(bdd_restrict(top,fdd_ithvar(0,op.Src)));
+				if (bdd_sat(topy & fdd_ithvar(0,0))) top |= dst & everywhere;
+				else top |= dst & bdd_relprod(mem,topy,fdd_ithset(0));
+				break;
+			case SUMMARY_STORE:
+				// as in processStore, without the strong update
+				topx = op.Dst ? out2in(bdd_restrict(top,dst)) : bdd_true();
+				topy = op.Src ? bdd_restrict(top,fdd_ithvar(0,op.Src)) : bdd_true();
+				if (bdd_sat(fdd_ithvar(0,0) & topx) && bdd_sat(everywhere & topy)) mem = bdd_true();
+				else mem |= topx & topy;
+				break;
+			case SUMMARY_MEMCOPY:
+				// as in processLibCall for LIBCALL_COPY
+				topx = op.Dst ? bdd_restrict(top,dst) : everywhere;
+				topy = op.Src ? bdd_restrict(top,fdd_ithvar(0,op.Src)) : everywhere;
+				if (bdd_sat(topy & everywhere)) contents = everywhere;
+				else contents = bdd_relprod(mem,out2in(topy),fdd_ithset(0));
+				mem |= (bdd_sat(topx & everywhere) ? bdd_true() : out2in(topx)) & contents;
+				break;
+			}
+		}
+		changed = top != oldtop || mem != oldmem;
+		// after the first round, loads that find nothing point everywhere,
+		// as handleUninitializedLoads makes the SEG's loads do
+		if (!changed && SummaryUndefLoads) {
+			bdd empty = fs.Loads - bdd_exist(top & fs.Loads,fdd_ithset(1));
+			if (bdd_sat(empty)) {
+				top |= empty & everywhere;
+				changed = true;
+			}
+		}
+	}
+}
+
+// apply the summary of target at the call node sn; the callee's own values
+// keep what they got from this call, so queries about them see every call
+bdd FlowSensitiveAliasAnalysis::applySummary(bdd *tpts, SEGNode *sn, std::vector<bdd> &argpts, const Function *target) {
+	unsigned int ti = getSEG(target)->getIndex();
+	const FuncSummary &fs = Summaries[SummaryOf[ti]];
+	const Instruction *i = sn->getInstruction();
+	bdd top, mem, newpts;
+	unsigned int n = 0;
+	DEBUG(dbgs() << "APPLY SUMMARY: " << target->getName() << "\n");
+	SummaryApplications++;
+	// the requeue after the first round needs to find this call
+	SummaryCalls.insert(sn);
+	// the caller's values, and the callee's formals bound to the arguments
+	top = *tpts - fs.Locals;
+	for (Function::const_arg_iterator ai=target->arg_begin(), ae=target->arg_end(); ai!=ae && n < argpts.size(); ++ai, ++n)
+		top |= fdd_ithvar(0,Value2Int.at(&*ai)) & (sn->getArgIds()->at(n) ? argpts[n] : fdd_ithvar(1,0));
+	mem = sn->getInSet();
+	solveSummary(fs,top,mem);
+	// the call's value points to whatever the callee returns
+	if (!i->getType()->isVoidTy() && Value2Int.count(i)) {
+		std::vector<unsigned> &rets = SummaryReturns[ti];
+		newpts = bdd_false();
+		for (unsigned int k = 0; k < rets.size(); k++)
+			newpts |= rets[k] ? bdd_restrict(top,fdd_ithvar(0,rets[k])) : fdd_ithvar(1,0);
+		newpts &= fdd_ithvar(0,Value2Int.at(i));
+		propagateTopLevel(tpts,&newpts,sn);
+	}
+	*tpts |= top & fs.Locals;
+	DEBUG(dbgs() << "SUMMARY OUT:\n"; printBDD(LocationCount,Int2Str,mem));
+	return mem;
+}
@@ -0,0 +1,67 @@
+//===- FSAATraceFormat.h - On-disk layout of fs-aa worklist traces ---------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// -fsaa-trace writes one record per worklist pop in this layout: a header,
+// the names of the functions and opcodes, then records until the end of the
+// file. Records are written as the solver runs, so their count is only known
+// from the file size. Integers are in the byte order of the machine that
+// wrote the trace (see ByteOrder). This header has no LLVM dependencies.
+//
+//===----------------------------------------------------------------------===//
+#ifndef FSAA_TRACE_FORMAT_H
+#define FSAA_TRACE_FORMAT_H
+
+#include <stdint.h>
+
+#define FSAA_TRACE_MAGIC     "FSAATRC"
+#define FSAA_TRACE_VERSION   1
+#define FSAA_TRACE_BYTEORDER 0x01020304u
+
+/// record kinds
+#define FSAA_TRACE_ROUND     1     // a doAnalysis round starts, Node is the round
+#define FSAA_TRACE_FUNCTION  2     // a function came off FuncWorkList
+#define FSAA_TRACE_NODE      3     // a SEG node came off its function's StmtWorkList
+
+/// node record flags
+#define FSAA_TRACE_TOP_CHANGED  1  // the top level points-to set changed
+#define FSAA_TRACE_OUT_CHANGED  2  // the node's Out set changed
+#define FSAA_TRACE_PRESERVE     4  // a preserving node, only propagated
+#define FSAA_TRACE_UNDEF        8  // a copy of an undefined value
+
+/// Cause of a node queued outside any node's transfer function
+#define FSAA_TRACE_NO_CAUSE  0xffffffffu
+
+/// FSAATraceHeader - at offset 0, followed by NamesSize bytes of NUL
+/// terminated names (FunctionCount function names in SEG index order, then
+/// OpcodeCount opcode names, the first for nodes without an instruction),
+/// then records from the next multiple of 8
+struct FSAATraceHeader {
+	char     Magic[8];          // FSAA_TRACE_MAGIC, NUL padded
+	uint32_t Version;           // FSAA_TRACE_VERSION
+	uint32_t ByteOrder;         // FSAA_TRACE_BYTEORDER as the writer stored it
+	uint32_t FunctionCount;
+	uint32_t OpcodeCount;
+	uint64_t NamesSize;
+};
+
+/// FSAATraceRecord - one worklist pop
+struct FSAATraceRecord {
+	uint64_t Nanos;             // since the trace was opened
+	uint32_t Kind;              // FSAA_TRACE_*
+	uint32_t Function;          // SEG index
+	uint32_t Node;              // position of the node in its SEG (the round for ROUND)
+	uint32_t Cause;             // index of the NODE record whose transfer function
+	                            // queued this node, or FSAA_TRACE_NO_CAUSE
+	uint32_t Queued;            // nodes this pop appended to the worklists
+	uint32_t OutNodes;          // BDD nodes in the Out set if it changed, else 0
+	uint16_t Opcode;            // index into the opcode names
+	uint16_t Flags;             // FSAA_TRACE_* flags
+	uint32_t Reserved;
+};
+
+#endif /* FSAA_TRACE_FORMAT_H */
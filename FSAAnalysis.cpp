@@ -11,6 +11,10 @@
 //===----------------------------------------------------------------------===//
 #include "FSAAnalysis.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/MemoryBuiltins.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
 
 STATISTIC(Functions,   "Functions: The # of functions in the module");
 STATISTIC(UninitLoads, "Uninit Loads: The # of uninitialized loads in the module");
@@ -19,6 +23,40 @@ STATISTIC(PointsEverywhere, "Nodes That Point Everywhere");
 STATISTIC(TopLevelSize, "Nodes in Top Level Points-To Set");
 STATISTIC(TopLevelPointerCount, "Nodes in Top Level Points-To Set");
 
+// Summarize functions bottom-up over the call graph, and apply the summaries
+// at their call sites instead of routing the caller's address-taken set
+// through the callee's SEG
+static cl::opt<bool> UseSummaries("fsaa-summaries",
+	cl::desc("Apply per-SCC transfer summaries at call sites instead of entering the callee's SEG"),
+	cl::init(false));
+
+// Keep the SEGs and their address-taken sets after the solve, so clients can
+// ask what memory holds at a given instruction (pointsToAt/aliasAt)
+static cl::opt<bool> KeepSets("fsaa-keep-sets",
+	cl::desc("Keep per-node points-to sets for program point queries"),
+	cl::init(false));
+
+// Time every phase of the analysis and write the times, peak RSS and BDD
+// node counts to this file as JSON
+static cl::opt<std::string> PhaseReport("fsaa-phase-report",
+	cl::desc("Write per-phase time and memory of the analysis to this file (JSON)"),
+	cl::value_desc("filename"), cl::init(""));
+
+// Profile the transfer functions, and print the hottest opcodes, functions
+// and SEG nodes when the analysis is done
+static cl::opt<bool> ProfileTransfer("fsaa-profile",
+	cl::desc("Profile the transfer functions by opcode, function and node"),
+	cl::init(false));
+static cl::opt<unsigned> ProfileTop("fsaa-profile-top",
+	cl::desc("Number of functions and nodes -fsaa-profile prints"),
+	cl::init(10));
+
+// Write a binary record of every worklist pop to this file, for
+// Trace/fsaa-trace to summarize
+static cl::opt<std::string> TraceFile("fsaa-trace",
+	cl::desc("Write a trace of the solver's worklist pops to this file"),
+	cl::value_desc("filename"), cl::init(""));
+
 bdd badLoads;
 bdd topLevelPointers;
 
@@ -30,71 +68,147 @@ using namespace llvm;
 #define DEBUG_TYPE "fsaa-preprocess"
 bool FlowSensitiveAliasAnalysis::runOnModule(Module &M){
 	int rnd = 0;
+	bool again;
+	std::string error;
 	// set stats to be zero initially
 	UninitLoads = 0;
 	LoadAgain = 0;
 	TopLevelSize = 0;
 	TopLevelPointerCount = 0;
+	NodeVisits = 0;
+	Phases.reset(RecordPhases || !PhaseReport.empty());
+	// answers and sets from an earlier run are stale
+	AliasCache.clear();
+	if (SetsKept) releaseSets();
+	// mod/ref queries fall back on the next analysis in the chain
+	InitializeAliasAnalysis(this);
 	// build SEG
+	Phases.begin("constructSEG");
 	constructSEG(M);
-	// initialize value maps
+	Phases.end();
+	Profile.reset(ProfileTransfer,Func2SEG.size());
+	if (!TraceFile.empty() && !Trace.open(TraceFile,Func2SEG,error))
+		errs() << "fs-aa: cannot write " << TraceFile << ": " << error << "\n";
+	// initialize value maps (allocation sites are found with TLI)
+	TLI = &getAnalysis<TargetLibraryInfo>();
+	Phases.begin("initializeValueMap");
 	LocationCount = initializeValueMap(M);
+	Phases.end();
+	// find summaries for library calls
+	Phases.begin("initializeLibCalls");
+	initializeLibCalls(M);
+	Phases.end();
 	// initialize bdd library
+	Phases.begin("pointsToInit");
 	pointsToInit(30000000,1000000,LocationCount);
+	Phases.end();
+	// compute function summaries, the caller map leaves summarized callees out
+	SummaryUndefLoads = false;
+	SummaryCalls.clear();
+	SummaryLoads = bdd_false();
+	if (UseSummaries) {
+		Phases.begin("initializeSummaries");
+		initializeSummaries(&getAnalysis<CallGraph>());
+		Phases.end();
+	}
 	// build caller map
+	Phases.begin("initializeCallerMap");
 	initializeCallerMap(&getAnalysis<CallGraph>());
+	Phases.end();
 	DEBUG(printValueMap());
 #ifdef REVMAP
-	Int2Str = reverseMap(&Value2Int);
+	Phases.begin("reverseMap");
+	Int2Str = reverseMap(&Value2Int,&HeapSites);
+	Int2Str->insert(std::pair<unsigned int,std::string*>(HeapId,new std::string("LIBCALL__HEAP")));
+	Phases.end();
 #else
 	Int2Str = NULL;
 #endif
 	DEBUG(printReverseMap(Int2Str));
 	// initialize worklists
+	Phases.begin("setupAnalysis");
 	initializeFuncWorkList(M);
 	// setup algorithm
 	TopLevelPTS = bdd_false();
 	loadNames = bdd_false();
 	constantNames = bdd_false();
+	globalLocations = bdd_false();
 	topLevelPointers = bdd_false();
 	setupAnalysis(M);
+	Phases.end();
 	// do algorithm while loads are uninitialized
 	do {
 		if (rnd >= 2) {
 			DEBUG(dbgs() << "BAD LOADS:\n"; printBDD(LocationCount,Int2Str,badLoads));
 			assert(false && "LOADS NOT INITIALIZED");
 		}
-		doAnalysis(M,rnd++);
-	} while (handleUninitializedLoads());
+		Phases.begin("doAnalysis",rnd);
+		doAnalysis(M,rnd);
+		Phases.end();
+		Phases.begin("handleUninitializedLoads",rnd++);
+		again = handleUninitializedLoads();
+		Phases.end();
+	} while (again);
+	Trace.close();
 	// print ouf final points-to set
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "fsaa-result"
 	DEBUG(dbgs()<<"\nFINAL:\n"; printBDD(LocationCount,Int2Str,TopLevelPTS));
 	DEBUG(std::cout<<std::endl);
 	dbgs()<<"Analysis Done\n";
+	Phases.begin("checkImprecision");
 	checkImprecision();
-	// cleanup whatever memory we can
-	clean();
+	Phases.end();
+	// queries only need the final top level sets, keep them as plain rows
+	Phases.begin("materializePointsTo");
+	materializePointsTo();
+	computeAliasClasses();
+	Phases.end();
+	// so do the mod/ref queries, through what each function reads and writes
+	Phases.begin("computeAccessSets");
+	computeAccessSets(M);
+	Phases.end();
+	// hand the results to other tools, while the names are still around
+	Phases.begin("exportResults");
+	exportResults(M);
+	Phases.end();
+	// the profile names functions and nodes, print it while they exist
+	if (Profile.enabled()) Profile.print(errs(),ProfileTop,Func2SEG);
+	// cleanup whatever memory we can, the BDD library included, unless
+	// program point queries need the per-node sets
+	if (KeepSets) {
+		PointIndex.assign(Func2SEG.size(),NULL);
+		SetsKept = true;
+	} else {
+		Phases.begin("clean");
+		clean();
+		pointsToFinalize();
+		Phases.end();
+	}
+	if (!PhaseReport.empty() && !Phases.writeJSON(PhaseReport,M.getModuleIdentifier(),error))
+		errs() << "fs-aa: cannot write " << PhaseReport << ": " << error << "\n";
 	// return false
 	return false;
 }
 
 // print out imprecision by checking who points everywhere
 void FlowSensitiveAliasAnalysis::checkImprecision() {
-	// otherwise, count how many top level variables point everywhere
-	for (unsigned int i = 0; i < LocationCount; i++)
-		if (bdd_sat(TopLevelPTS & topLevelPointers & fdd_ithvar(0,i) & fdd_ithvar(1,0)))
-				PointsEverywhere++;
+	// otherwise, count how many top level variables point everywhere, as the
+	// pointers paired with 0, in one pass over the BDD
+	PointsEverywhere = (unsigned)bddDomainCount(TopLevelPTS & topLevelPointers & fdd_ithvar(1,0),0);
 }
 
 void FlowSensitiveAliasAnalysis::clean(){
-	for(std::map<const Function*, SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi){
-		SEG* seg = mi->second;
+	for(std::vector<SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi){
+		SEG* seg = *mi;
 		delete seg;
 	}
-	for(std::map<const Function*, StmtList*>::iterator vi=StmtWorkList.begin(), ve=StmtWorkList.end(); vi!=ve; ++vi){
-		delete vi->second;
+	Func2SEG.clear();
+	Inst2Node.clear();
+	for(std::vector<StmtList*>::iterator vi=StmtWorkList.begin(), ve=StmtWorkList.end(); vi!=ve; ++vi){
+		delete *vi;
 	}
+	StmtWorkList.clear();
 #ifdef REVMAP
 	for(std::map<unsigned int,std::string*>::iterator mi=Int2Str->begin(), me=Int2Str->end(); me!=mi; ++mi){
 		delete mi->second;
@@ -102,13 +216,32 @@ void FlowSensitiveAliasAnalysis::clean(){
 	delete Int2Str;
 #endif
 	for(CallerMap::iterator mi=Func2Calls.begin(), me=Func2Calls.end(); me!=mi; ++mi){
-		delete mi->second;
+		delete *mi;
 	}
+	Func2Calls.clear();
+	Int2Func.clear();
+	Summaries.clear();
+	SummaryOf.clear();
+	SummaryReturns.clear();
+	SummaryOnly.clear();
+	SummaryCalls.clear();
+	FuncQueued.clear();
+	Type2Funcs.clear();
+	// drop our references before the BDD library shuts down
+	TopLevelPTS = bdd_false();
+	loadNames = bdd_false();
+	constantNames = bdd_false();
+	globalLocations = bdd_false();
+	badLoads = bdd_false();
+	topLevelPointers = bdd_false();
+	SummaryLoads = bdd_false();
 }
 
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "fsaa-seg"
 void FlowSensitiveAliasAnalysis::constructSEG(Module &M) {
+	// the SEGs are gone after a run, but queries keep using their indices
+	Func2Index.clear();
 	for (Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi) {
 		Functions ++;
 		const Function * f = &*mi;
@@ -117,8 +250,15 @@ void FlowSensitiveAliasAnalysis::constructSEG(Module &M) {
 		// extend our inst node map by this SEG
 		seg->extendInstNodeMap(&Inst2Node);
 		// DEBUG(seg->dump());
-		Func2SEG.insert( std::pair<const Function*, SEG*>(f, seg) );
+		// number SEGs densely in module order
+		seg->setIndex(Func2SEG.size());
+		Func2Index[f] = seg->getIndex();
+		Func2SEG.push_back(seg);
 	}
+	// per-function tables are indexed by SEG index
+	Func2Calls.assign(Func2SEG.size(),NULL);
+	StmtWorkList.assign(Func2SEG.size(),NULL);
+	FuncQueued.assign(Func2SEG.size(),false);
 }
 
 #undef  DEBUG_TYPE
@@ -142,12 +282,12 @@ void FlowSensitiveAliasAnalysis::addCaller(SEGNode *callInst, const Function *ca
 		return;
 	}
 	// add callee to map if it is not present
-	if (Func2Calls.count(callee) == 0) {
-		Func2Calls.insert(std::pair<const Function*,CallerEntry*>(callee,new CallerEntry()));
-	}
-	// add callInst to callee's internal map, insert RetData for this call
+	CallerEntry *&ce = Func2Calls[getSEG(callee)->getIndex()];
+	if (ce == NULL) ce = new CallerEntry();
+	// add callInst to callee's internal map, insert RetData for this call once
+	if (!ce->Sites.insert(callInst).second) return;
 	DEBUG(dbgs() << "CALL FROM " << caller->getName() << " TO " << callee->getName() << " NODE " << *callInst << "\n");
-	Func2Calls.at(callee)->Calls.push_back(new RetData(&Value2Int,callInst));
+	ce->Calls.push_back(new RetData(&Value2Int,callInst));
 }
 
 // build caller map used in return processing
@@ -169,6 +309,8 @@ void FlowSensitiveAliasAnalysis::initializeCallerMap(CallGraph *cg) {
 			assert(isa<CallInst>(v) || isa<InvokeInst>(v));
 			Instruction *i = cast<Instruction>(v);
 			const Function *callee = nit->second->getFunction();
+			// summarized callees never return through their SEG
+			if (callee != NULL && hasSummary(getSEG(callee))) continue;
 			// add the caller
 			addCaller(i,callee);
 		}
@@ -179,6 +321,7 @@ void FlowSensitiveAliasAnalysis::initializeCallerMap(CallGraph *cg) {
 #define DEBUG_TYPE "fsaa-valuemap"
 unsigned FlowSensitiveAliasAnalysis::initializeValueMap(Module &M){
 	unsigned id = 1;
+	HeapSites.clear();
 	std::pair<std::map<const Value*, unsigned>::iterator, bool> chk;
 	/// map global variables
 	for(Module::global_iterator mi=M.global_begin(), me=M.global_end(); mi!=me; ++mi) {
@@ -210,8 +353,8 @@ unsigned FlowSensitiveAliasAnalysis::initializeValueMap(Module &M){
 		}
 	}
 	/// map local statements
-	for(std::map<const Function*, SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
-		SEG *seg = mi->second;
+	for(std::vector<SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
+		SEG *seg = *mi;
 #ifdef ENABLE_OPT_1
 		std::vector<SEGNode *> SingleCopySNs;
 		SingleCopySNs.clear();
@@ -245,6 +388,11 @@ unsigned FlowSensitiveAliasAnalysis::initializeValueMap(Module &M){
 			TopLevelSize ++;
 			// give the allocated location an anonymous id
 			if(isa<AllocaInst>(inst)) id++;
+			// so does every call to a heap allocator
+			else if(isAllocationFn(inst,TLI)) {
+				HeapSites.insert(inst);
+				id++;
+			}
 		}
 #ifdef ENABLE_OPT_1
 		for(std::vector<SEGNode *>::iterator vi=SingleCopySNs.begin(), ve=SingleCopySNs.end(); vi!=ve; ++vi){
@@ -263,6 +411,8 @@ unsigned FlowSensitiveAliasAnalysis::initializeValueMap(Module &M){
 		seg->pruneSingleCopy(SingleCopySNs);
 #endif
 	}
+	/// memory returned by library calls
+	HeapId = id++;
 	return id;
 }
 
@@ -271,16 +421,17 @@ unsigned FlowSensitiveAliasAnalysis::initializeValueMap(Module &M){
 void FlowSensitiveAliasAnalysis::initializeFuncWorkList(Module &M){
 	for(Module::iterator mi=M.begin(), me=M.end(); mi!=me; ++mi) {
 		Function * f = &*mi;
-		FuncWorkList.push_back(f);
 		initializeStmtWorkList(f);
+		queueFunction(getSEG(f));
 	}
 }
 
 void FlowSensitiveAliasAnalysis::initializeStmtWorkList(Function *F){
 	DEBUG(dbgs() << "WORKLIST FOR: " << F->getName() << "\n");
-	assert( Func2SEG.find(F)!=Func2SEG.end() && "seg doesn't exist");
-	SEG *seg = Func2SEG.find(F)->second;
-	StmtList *stmtList = new StmtList;
+	SEG *seg = getSEG(F);
+	StmtWorkList[seg->getIndex()] = new StmtList;
+	// the summary stands in for this SEG at every call
+	if (summaryOnly(seg)) return;
 	for(SEG::iterator si=seg->begin(), se=seg->end(); si!=se; ++si) {
 		SEGNode *sn = &*si;
 		const Instruction *inst = sn->getInstruction();
@@ -293,15 +444,25 @@ void FlowSensitiveAliasAnalysis::initializeStmtWorkList(Function *F){
 		if(isa<ReturnInst>(inst))
 #endif
 			continue;
-		stmtList->push_back(sn);
+		queueNode(sn);
 	}
-	StmtWorkList.insert(std::pair<Function*, StmtList*>(F, stmtList));
 }
 
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "fsaa-preprocess"
+void FlowSensitiveAliasAnalysis::initializeFuncTypes() {
+	Type2Funcs.clear();
+	for (std::vector<SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
+		const Function *f = (*mi)->getFunction();
+		// declarations are never added to Int2Func, so they can't be targets
+		if ((*mi)->isDeclaration()) continue;
+		bdd &funs = Type2Funcs[f->getFunctionType()];
+		funs |= fdd_ithvar(1,Value2Int.at(f)+1);
+	}
+}
+
 void FlowSensitiveAliasAnalysis::preprocessFunction(const Function *f) {
-	SEG* seg = Func2SEG.at(f);
+	SEG* seg = getSEG(f);
 	// don't need to preprocess declarations
 	if (seg->isDeclaration()) return;
 	SEGNode *entry = seg->getEntryNode();
@@ -309,17 +470,18 @@ void FlowSensitiveAliasAnalysis::preprocessFunction(const Function *f) {
 	std::vector<unsigned int> *ArgIds = new std::vector<unsigned int>();
 	unsigned int fid = Value2Int.at(f);
 	// add to Int2Func mapping
-	Int2Func.insert(std::pair<unsigned int,const Function *>(fid+1,f));
+	Int2Func[fid+1] = f;
 	// function's hidden pair to points-to set
 	TopLevelPTS = TopLevelPTS | (fdd_ithvar(0,fid) & fdd_ithvar(1,fid+1));
-	// for each parameter, add it's hidden pair to the points-to set
+	// for each parameter, add it's hidden pair to the points-to set, unless
+	// only summaries bind the parameters
 	for(Function::const_arg_iterator ai=f->arg_begin(), ae=f->arg_end(); ai!=ae; ++ai) {
 		unsigned int argid = Value2Int.at(&*ai);
 		bdd arg = fdd_ithvar(0,argid);
 		// add argument id to argids
 		ArgIds->push_back(argid);
 		// add points-to pair to Top points-to set
-		TopLevelPTS = TopLevelPTS | (arg & fdd_ithvar(1,argid+1));
+		if (!summaryOnly(seg)) TopLevelPTS = TopLevelPTS | (arg & fdd_ithvar(1,argid+1));
 		// add argument to static data
 		StaticData->push_back(arg);
 		// if this is a pointer, add it to the top level pointer set
@@ -380,6 +542,7 @@ void FlowSensitiveAliasAnalysis::initializeGlobals(Module &M) {
 		// add global to top level pointsto set and initialized values to addrtaken set
 		unsigned int id = Value2Int.at(v);
 		globalAddrTaken |= processGlobal(id,&TopLevelPTS,v);
+		globalLocations |= fdd_ithvar(1,id+1);
 		// if they are constants, add to constant names
 		if (v->isConstant()) constantNames |= fdd_ithvar(0,id);
 		// if this is a pointer, add it to the top level pointer set
@@ -389,10 +552,10 @@ void FlowSensitiveAliasAnalysis::initializeGlobals(Module &M) {
 		}
 	}
 	// propagate global pts to each function's entry node
-	for (std::map<const Function*, SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
+	for (std::vector<SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
 		// get SEG entry node
-		if (mi->second->isDeclaration()) continue;
-		SEGNode *entry = mi->second->getEntryNode();
+		if ((*mi)->isDeclaration() || summaryOnly(*mi)) continue;
+		SEGNode *entry = (*mi)->getEntryNode();
 		// setup entry node inset and outset
 		entry->setInSet(globalAddrTaken);
 		entry->setOutSet(globalAddrTaken);
@@ -435,6 +598,15 @@ bool FlowSensitiveAliasAnalysis::handleUninitializedLoads() {
 			changed = changed | propagateTopLevel(&TopLevelPTS,&newpts,sn);
 		}
 	}
+	// summaries only see their loads during a call: apply them again, with
+	// the loads that find nothing pointing everywhere
+	if (!SummaryUndefLoads && bdd_sat(uninitializedLoads & SummaryLoads)) {
+		SummaryUndefLoads = true;
+		for (it = SummaryCalls.begin(), end = SummaryCalls.end(); it != end; ++it) {
+			if (queueNode(*it)) changed = true;
+			queueFunction((*it)->getParent());
+		}
+	}
 	// return true if we need to do more processing
 	badLoads = uninitializedLoads;
 	return changed;
@@ -443,14 +615,17 @@ bool FlowSensitiveAliasAnalysis::handleUninitializedLoads() {
 void FlowSensitiveAliasAnalysis::setupAnalysis(Module &M) {
 	// intialize points-to sets for globals, propagate to each function's entry node
 	initializeGlobals(M);
+	// index functions by type before any indirect call looks them up
+	initializeFuncTypes();
+	Int2Func.assign(LocationCount,NULL);
 	// iterate through each function and each node
-	for (std::map<const Function*, SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
+	for (std::vector<SEG*>::iterator mi=Func2SEG.begin(), me=Func2SEG.end(); mi!=me; ++mi) {
+		SEG *seg = *mi;
 		// preprocess functions
-		preprocessFunction(mi->first);
+		preprocessFunction(seg->getFunction());
 		// add function names to constants list
-		constantNames |= fdd_ithvar(0,Value2Int.at(mi->first));
+		constantNames |= fdd_ithvar(0,Value2Int.at(seg->getFunction()));
 		// preprocess every node in SEG
-		SEG *seg = mi->second;
 		for(SEG::iterator sni=seg->begin(), sne=seg->end(); sni!=sne; ++sni) {
 			SEGNode *sn = &*sni;
 			const Instruction *i = sn->getInstruction();
@@ -500,17 +675,23 @@ void FlowSensitiveAliasAnalysis::setupAnalysis(Module &M) {
 
 void FlowSensitiveAliasAnalysis::doAnalysis(Module &M, int round) {
 	int ret = 0;
+	bdd traceTop, traceOut;
+	Trace.round(round);
 	// iterate through each function
 	while(!FuncWorkList.empty()){
-		const Function *f = FuncWorkList.front();
+		unsigned fi = FuncWorkList.front();
 		FuncWorkList.pop_front();
-		StmtList *stmtList = StmtWorkList.at(f);
+		FuncQueued[fi] = false;
+		Trace.popFunction(fi);
+		StmtList *stmtList = StmtWorkList[fi];
 		// iterate through each node in the worklist
 		while (!stmtList->empty()) {
 			// mark nodes processed in later rounds
 			LoadAgain += round > 0 ? 1 : 0;
+			NodeVisits++;
 			// get our current entry
 			SEGNode *sn = stmtList->front(); stmtList->pop_front();
+			sn->setQueued(false);
 			// debugging statements
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "fsaa-toplevel"
@@ -521,17 +702,27 @@ void FlowSensitiveAliasAnalysis::doAnalysis(Module &M, int round) {
 				DEBUG(dbgs()<<"Processing :\t"<<*sn<<"\t"<<sn->getInstruction()->getOpcodeName()<<"\t"<<isa<CallInst>(sn->getInstruction())<<"\n");
 			// if this is a preserving node, just propagateAddrTaken
 			if (!sn->isnPnode()) {
+				if (Trace.enabled()) traceNodeBegin(sn,FSAA_TRACE_PRESERVE,traceTop,traceOut);
+				Profile.begin();
 				propagateAddrTaken(sn);
+				Profile.end("preserve",fi,sn);
+				if (Trace.enabled()) traceNodeEnd(sn,traceTop,traceOut);
 				continue;
 			}
 #ifdef ENABLE_OPT_1
 			// if this a copy of a node, ignore it
 			if(sn->singleCopy() && sn->undefSource()){
+				if (Trace.enabled()) traceNodeBegin(sn,FSAA_TRACE_UNDEF,traceTop,traceOut);
+				Profile.begin();
 				processUndef(&TopLevelPTS, sn);
+				Profile.end("undef",fi,sn);
+				if (Trace.enabled()) traceNodeEnd(sn,traceTop,traceOut);
 				continue;
 			}
 #endif
 			// otherwise, do standard processing
+			if (Trace.enabled()) traceNodeBegin(sn,0,traceTop,traceOut);
+			Profile.begin();
 			switch(sn->getInstruction()->getOpcode()) {
 				case Instruction::Alloca: ret = processAlloc(&TopLevelPTS,sn); break;
 				case Instruction::PHI:	  ret = processCopy(&TopLevelPTS,sn);  break;
@@ -568,6 +759,8 @@ void FlowSensitiveAliasAnalysis::doAnalysis(Module &M, int round) {
 					break;
 				default: assert(false && "Out of bounds Instr Type");
 			}
+			Profile.end(sn->getInstruction()->getOpcodeName(),fi,sn);
+			if (Trace.enabled()) traceNodeEnd(sn,traceTop,traceOut);
 			// print out sets
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "fsaa-addrtaken"
@@ -577,6 +770,21 @@ void FlowSensitiveAliasAnalysis::doAnalysis(Module &M, int round) {
 	}
 }
 
+// remember the sets a node's transfer function may change, and open its record
+void FlowSensitiveAliasAnalysis::traceNodeBegin(SEGNode *sn, unsigned flags, bdd &top, bdd &out) {
+	top = TopLevelPTS;
+	out = sn->getOutSet();
+	Trace.beginNode(sn,sn->getInstruction() ? sn->getInstruction()->getOpcode() : 0,flags);
+}
+
+// comparing roots is enough to tell whether a set changed; only count the
+// nodes of an Out set that did
+void FlowSensitiveAliasAnalysis::traceNodeEnd(SEGNode *sn, const bdd &top, const bdd &out) {
+	bdd now = sn->getOutSet();
+	bool changed = now != out;
+	Trace.endNode(top != TopLevelPTS,changed,changed ? bdd_nodecount(now) : 0);
+}
+
 /// Register this pass
 char FlowSensitiveAliasAnalysis::ID = 0;
 static RegisterPass<FlowSensitiveAliasAnalysis> X("fs-aa", "Semi-sparse Flow Sensitive Pointer Analysis",
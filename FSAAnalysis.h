@@ -12,15 +12,19 @@
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Pass.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Support/Debug.h"
 #include "bdd.h"
 #include "fdd.h"
 #include "SEG.h"
 #include "BDDMisc.h"
+#include "FSAAStats.h"
 #include <set>
 #include <map>
 #include <list>
+#include <deque>
 #include <vector>
 #include <algorithm>
 
@@ -30,20 +34,69 @@ typedef std::vector<SEGNode*> NodeVec;
 typedef std::list<SEGNode*> StmtList;
 struct CallerEntry {
 	std::vector<RetData*> Calls;
+	std::set<SEGNode*> Sites;      // call nodes already in Calls
 	~CallerEntry() {
 		for(std::vector<RetData*>::iterator mi=Calls.begin(), me=Calls.end(); mi!=me; ++mi){
 			delete *mi;
 		}
 	}
 };
-typedef std::map<const Function*,CallerEntry*> CallerMap;
-typedef std::map<const Function*, std::list<SEGNode*>*> WorkList;
+typedef std::vector<CallerEntry*> CallerMap;
+
+/// SummaryOp - one step of a function summary, on value ids; an id of 0
+/// stands for an undefined value, which points everywhere
+#define SUMMARY_ALLOC   0      // Dst points to location Src (0: everywhere)
+#define SUMMARY_COPY    1      // Dst points where Src points
+#define SUMMARY_LOAD    2      // Dst points where the memory Src points to points
+#define SUMMARY_STORE   3      // the memory Dst points to points where Src points
+#define SUMMARY_MEMCOPY 4      // the memory Dst points to gets what the memory Src points to holds
+struct SummaryOp {
+	unsigned int Kind;
+	unsigned int Dst;
+	unsigned int Src;
+};
+
+/// FuncSummary - the transfer summary of a call graph SCC, shared by its
+/// functions: the steps of their instructions and of everything they call,
+/// solved flow-insensitively against the caller's memory at each call
+struct FuncSummary {
+	std::vector<SummaryOp> Ops;
+	bdd Locals;                    // ids (domain 0) the steps define, formals included
+	bdd Loads;                     // ids (domain 0) the loads define
+};
+
+/// flags of a location in the final points-to rows
+#define LOC_EVERYWHERE 1       // points to everything
+#define LOC_CONSTANT   2       // names a constant
+
+/// LibCallSummary - what a call to a library declaration does to pointers
+#define LIBCALL_NOEFFECT 0     // no effect on pointers
+#define LIBCALL_ALLOC    1     // returns fresh memory
+#define LIBCALL_RETARG   2     // returns (a pointer into) argument retArg
+#define LIBCALL_COPY     4     // copies memory of srcArg into memory of dstArg
+struct LibCallSummary {
+	unsigned int flags;
+	int retArg;
+	int dstArg;
+	int srcArg;
+};
+
+/// AccessSet - the abstract locations a function may read (or write)
+struct AccessSet {
+	bool Any;                      // may touch any location
+	std::vector<unsigned> Locs;    // otherwise, these locations (sorted)
+	AccessSet() : Any(false) {}
+};
 
 class FlowSensitiveAliasAnalysis : public ModulePass, public AliasAnalysis {
 private:
 
-	/// Func2SEG - mapping from Function to corresponding SEG
-	std::map<const Function*, SEG*> Func2SEG;
+	/// Func2SEG - the SEG of each function, by SEG index
+	std::vector<SEG*> Func2SEG;
+
+	/// Func2Index - the SEG index of each function (off the solver's hot path;
+	/// nodes know their SEG)
+	DenseMap<const Function*, unsigned> Func2Index;
 
 	/// Value2Int - mapping from Value(Global Variable, Function, Local
 	/// Statement are included) to unique Id
@@ -52,22 +105,65 @@ private:
 	/// Int2Str - for debugging purposes
 	std::map<unsigned int,std::string*> *Int2Str;
 
-	/// FuncWorkList - Functions need to be processed
-	std::list<const Function*> FuncWorkList;
+	/// FuncWorkList - SEG indices of functions need to be processed,
+	/// FuncQueued[i] is set while function i is in it
+	std::deque<unsigned> FuncWorkList;
+	std::vector<bool> FuncQueued;
 
 	/// StmtWorkList - the main algorithm iterate on it.
-	/// For each function, keep a statement list to work on for it.
-	std::map<const Function*, StmtList*> StmtWorkList;
+	/// For each function (by SEG index), keep a statement list to work on for it.
+	std::vector<StmtList*> StmtWorkList;
 
-	/// Int2Func - keeps a mapping from ints to functions, need for (pre)processCall
-	std::map<unsigned int,const Function*> Int2Func;
+	/// Int2Func - keeps a mapping from ints to functions, need for (pre)processCall;
+	/// indexed by the function's hidden id, NULL for every other id
+	std::vector<const Function*> Int2Func;
+
+	/// Type2Funcs - for each function type, the names (domain 1) of the defined
+	/// functions of that type; indirect calls only ever look at their own bucket
+	std::map<const Type*,bdd> Type2Funcs;
 
 	/// Inst2Node - keeps mapping from Instruction * to SEGNode *
 	InstNodeMap Inst2Node;
 
-	/// Func2Calls - keeps mapping from Function * to SEGNode * callers
+	/// Func2Calls - keeps the SEGNode * callers of each function, by SEG index
+	/// (NULL if there are none)
 	CallerMap Func2Calls;
 
+	/// TLI - recognizes library functions among the declarations
+	const TargetLibraryInfo *TLI;
+
+	/// LibSummaries - summaries of the library declarations called in the module
+	std::map<const Function*,LibCallSummary> LibSummaries;
+
+	/// Summaries - with -fsaa-summaries, the summaries of the call graph SCCs
+	/// that have one; SummaryOf - by SEG index, the summary of each function,
+	/// -1 if calls to it go through its SEG; empty without summaries
+	std::vector<FuncSummary> Summaries;
+	std::vector<int> SummaryOf;
+
+	/// SummaryReturns - by SEG index, the ids of the values each summarized
+	/// function returns (0 for an undefined one)
+	std::vector<std::vector<unsigned> > SummaryReturns;
+
+	/// SummaryOnly - by SEG index, set for summarized functions called from
+	/// outside their SCC: every such call applies the summary, so their own
+	/// SEG is never solved
+	std::vector<bool> SummaryOnly;
+
+	/// SummaryLoads - the loads of every summary; SummaryCalls - the call
+	/// nodes that applied one; SummaryUndefLoads - once set, loads that find
+	/// nothing in a summary point everywhere
+	bdd SummaryLoads;
+	std::set<SEGNode*> SummaryCalls;
+	bool SummaryUndefLoads;
+
+	/// HeapSites - calls to heap allocators; like allocas, each one has an
+	/// anonymous id (its own id+1) for the memory it returns
+	std::set<const Value*> HeapSites;
+
+	/// HeapId - the location standing for memory returned by other library calls
+	unsigned HeapId;
+
 	/// LocationCount - the total number of top variable and address-taken variable
 	unsigned LocationCount;
 
@@ -80,9 +176,118 @@ private:
 	/// names of constant values
 	bdd constantNames;
 
+	/// locations (domain 1) of all global variables, roots of every call filter
+	bdd globalLocations;
+
 	/// set of SEGNodes for load empty load instructions
 	std::set<SEGNode*> undefLoadNodes;
 
+	/// PtsOffsets/PtsTargets - the final top level points-to sets in compressed
+	/// sparse rows: the pointees of id v are PtsTargets[PtsOffsets[v]] up to
+	/// PtsTargets[PtsOffsets[v+1]], sorted, without location 0 (everything);
+	/// the row of an id that points everywhere is empty, LocFlags says so
+	std::vector<unsigned> PtsOffsets;
+	std::vector<unsigned> PtsTargets;
+
+	/// LocFlags - LOC_EVERYWHERE/LOC_CONSTANT for each id, next to the rows
+	std::vector<unsigned char> LocFlags;
+
+	/// AliasClass - for each id, the representative of its alias class: ids
+	/// whose rows share a pointee (transitively) are in the same class, so
+	/// ids in different classes never alias
+	std::vector<unsigned> AliasClass;
+
+	/// computeAliasClasses - union-find over the rows, fills AliasClass
+	void computeAliasClasses();
+
+	/// ConstantLocs - the memory locations (pointees) of constant globals and
+	/// functions, which nothing writes to
+	BitVector ConstantLocs;
+
+	/// materializePointsTo - fill the rows and flags from TopLevelPTS and
+	/// constantNames, so the BDDs can go away after the solve
+	void materializePointsTo();
+
+	/// pointsEverywhere/isConstantLoc/pointsToLoc - lookups on the rows
+	bool pointsEverywhere(unsigned int v) { return LocFlags[v] & LOC_EVERYWHERE; }
+	bool isConstantLoc(unsigned int v)    { return LocFlags[v] & LOC_CONSTANT; }
+	bool pointsToLoc(unsigned int v, unsigned int t) {
+		if (t == 0 || pointsEverywhere(v)) return pointsEverywhere(v);
+		return std::binary_search(PtsTargets.begin()+PtsOffsets[v],PtsTargets.begin()+PtsOffsets[v+1],t);
+	}
+
+	/// FuncReads/FuncWrites - the locations each defined function, and
+	/// everything it calls, may read and write, by SEG index; built from the
+	/// rows after the solve
+	std::vector<AccessSet> FuncReads;
+	std::vector<AccessSet> FuncWrites;
+
+	/// computeAccessSets - fill FuncReads/FuncWrites from the loads, stores
+	/// and calls of each function, then close them over the (resolved) calls
+	void computeAccessSets(Module &M);
+	void addPointees(AccessSet &s, const Value *p);
+	void addCallAccesses(ImmutableCallSite cs, const Function *f, AccessSet &reads, AccessSet &writes);
+
+	/// mayAccess - may s hold a location id v points to?
+	bool mayAccess(const AccessSet &s, unsigned int v);
+
+	/// exportResults - with -fsaa-export, write names, rows and access sets
+	/// in the FSAAExportFormat.h layout
+	void exportResults(Module &M);
+
+	/// SetsKept - true while the SEGs and the BDD library outlive the solve
+	/// (-fsaa-keep-sets), for program point queries
+	bool SetsKept;
+
+	/// PointIndex - for each function (by SEG index), the address-taken
+	/// points-to set just before each instruction, built on the first
+	/// program point query into the function
+	std::vector<DenseMap<const Instruction*,bdd>*> PointIndex;
+
+	/// memoryStateAt - the address-taken points-to set just before I
+	bool memoryStateAt(const Instruction *I, bdd &state);
+	void buildPointIndex(SEG *seg);
+
+	/// releaseSets - free what -fsaa-keep-sets kept alive
+	void releaseSets();
+
+	/// Phases - time and memory of each phase of the last run, for
+	/// -fsaa-phase-report
+	PhaseRecorder Phases;
+
+	/// Profile - cost of the transfer functions of the last run, for
+	/// -fsaa-profile
+	TransferProfiler Profile;
+
+	/// Trace - the worklist trace of the current run, for -fsaa-trace
+	WorklistTrace Trace;
+	void traceNodeBegin(SEGNode *sn, unsigned flags, bdd &top, bdd &out);
+	void traceNodeEnd(SEGNode *sn, const bdd &top, const bdd &out);
+
+	/// RecordPhases - record phases even without -fsaa-phase-report, for
+	/// drivers that read them through getPhases
+	bool RecordPhases;
+
+	/// NodeVisits - SEG nodes taken off the worklists in the last run
+	uint64_t NodeVisits;
+
+	/// AliasCache - answers to earlier alias queries, keyed on the ordered
+	/// pair of value ids; cleared whenever the analysis runs again
+	DenseMap<std::pair<unsigned,unsigned>, AliasResult> AliasCache;
+
+	/// computeAlias - the uncached alias query
+	AliasResult computeAlias(const Value *v1, const Value *v2, unsigned int l1, unsigned int l2);
+
+	/// aliasPrecheck - answer a query from the flags and single lookups;
+	/// false if only comparing the points-to rows of l1 and l2 can tell
+	bool aliasPrecheck(const Value *v1, const Value *v2, unsigned int l1, unsigned int l2, AliasResult &res);
+
+	/// valueId - the id of a value, 0 if it has none
+	unsigned int valueId(const Value *v) {
+		std::map<const Value*, unsigned>::iterator vi = Value2Int.find(v);
+		return vi == Value2Int.end() ? 0 : vi->second;
+	}
+
 	virtual void getAnalysisUsage(AnalysisUsage &AU) const {
 		AU.addRequired<AliasAnalysis>();
 		AU.addRequired<TargetLibraryInfo>();
@@ -109,6 +314,49 @@ private:
 	/// initializeCallerMap - build Function to SEGNode* map for return
 	void initializeCallerMap(CallGraph *C);
 
+	/// initializeSummaries - build Summaries bottom-up over the call graph,
+	/// one SCC at a time
+	void initializeSummaries(CallGraph *C);
+	bool summarizeFunction(const Function *f, std::vector<SummaryOp> &ops, std::set<int> &callees);
+
+	/// hasSummary - true if calls to the function of seg apply its summary
+	bool hasSummary(SEG *seg) {
+		return !SummaryOf.empty() && SummaryOf[seg->getIndex()] >= 0;
+	}
+
+	/// summaryOnly - true if the SEG of seg is left alone
+	bool summaryOnly(SEG *seg) {
+		return !SummaryOnly.empty() && SummaryOnly[seg->getIndex()];
+	}
+
+	/// applySummary - apply the summary of target at call node sn, return the
+	/// address-taken set after the call
+	bdd applySummary(bdd *tpts, SEGNode *sn, std::vector<bdd> &argpts, const Function *target);
+	void solveSummary(const FuncSummary &fs, bdd &top, bdd &mem);
+
+	/// getSEG - look up the SEG of a function
+	SEG *getSEG(const Function *f) {
+		DenseMap<const Function*, unsigned>::iterator fi = Func2Index.find(f);
+		assert(fi != Func2Index.end() && "seg doesn't exist");
+		return Func2SEG[fi->second];
+	}
+
+	/// queueFunction/queueNode - append to the worklists if absent,
+	/// return true if append occurred
+	bool queueFunction(SEG *seg) {
+		if (FuncQueued[seg->getIndex()]) return false;
+		FuncQueued[seg->getIndex()] = true;
+		FuncWorkList.push_back(seg->getIndex());
+		return true;
+	}
+	bool queueNode(SEGNode *sn) {
+		if (sn->isQueued()) return false;
+		sn->setQueued(true);
+		StmtWorkList[sn->getParent()->getIndex()]->push_back(sn);
+		if (Trace.enabled()) Trace.queued(sn);
+		return true;
+	}
+
 	/// addCaller - invoked to add callers to caller map
 	void addCaller(const Instruction *i, const Function *f);
 	void addCaller(SEGNode *c, const Function *f);
@@ -125,6 +373,12 @@ private:
 	/// printValueMap - print out debug information of value mapping.
 	void printValueMap();
 
+	/// initializeFuncTypes - bucket defined functions by type into Type2Funcs
+	void initializeFuncTypes();
+
+	/// initializeLibCalls - find a summary for each library declaration in LibSummaries
+	void initializeLibCalls(Module &M);
+
 	/// add Int2Func mapping, build default points-to set for arguments
 	void preprocessFunction(const Function *f);
 
@@ -136,10 +390,18 @@ private:
 
 public:
 	static char ID;
-	FlowSensitiveAliasAnalysis() : ModulePass(ID){
+	FlowSensitiveAliasAnalysis() : ModulePass(ID), SummaryUndefLoads(false), SetsKept(false), RecordPhases(false), NodeVisits(0) {
 		//initializeFlowSensitiveAliasAnalysisPass(*PassRegistry::getPassRegistry());
 	}
 
+	/// recordPhases/getPhases - per-phase costs of the last run; these are
+	/// inline so tools that load the pass as a plugin can use them
+	void recordPhases(bool on) { RecordPhases = on; }
+	const PhaseRecorder &getPhases() const { return Phases; }
+
+	/// getNodeVisits - worklist iterations of the last run
+	uint64_t getNodeVisits() const { return NodeVisits; }
+
 	virtual void initializePass() {
 		InitializeAliasAnalysis(this);
 	}
@@ -148,74 +410,49 @@ public:
 
 	//copy from noaa
 
-	AliasResult aliasCheck(unsigned int v1, unsigned int v2) {
-		assert(v1 <= LocationCount && v2 <= LocationCount);
-		// get intersection of two points-to sets
-		bdd test = bdd_restrict(TopLevelPTS,fdd_ithvar(0,v1)) & bdd_restrict(TopLevelPTS,fdd_ithvar(0,v2));
-		// if they intersect, they may alias
-		if (bdd_sat(test)) {
-			// if they both point to a single value, they must alias
-			if (bdd_satcount(test) == 1.0) return MustAlias;
-			else return MayAlias;
-		// otherwise, they don't alias
-		} else return NoAlias;
-	}
+	/// aliasCheck - compare the points-to sets of two top level variables
+	AliasResult aliasCheck(unsigned int v1, unsigned int v2);
 
-	virtual AliasResult alias(const Location &LocA, const Location &LocB) {
-		std::map<const Value*, unsigned>::iterator ret1, ret2;
-		const Value *v1, *v2;
-		unsigned int l1, l2;
-		const Type *t1, *t2;
-		bool p1, p2, c1, c2;
-		// get these location's values, types, indices in BDD, and if they are constants
-		v1 = LocA.Ptr;
-		v2 = LocB.Ptr;
-		t1 = v1->getType();
-		t2 = v2->getType();
-		p1 = t1->isPtrOrPtrVectorTy() || t1->isVectorTy();
-		p2 = t2->isPtrOrPtrVectorTy() || t2->isVectorTy();
-		ret1 = Value2Int.find(v1);
-		ret2 = Value2Int.find(v2);
-		l1 = ret1 == Value2Int.end() ? 0 : ret1->second;
-		l2 = ret2 == Value2Int.end() ? 0 : ret2->second;
-		c1 = l1 ? bdd_sat(constantNames & fdd_ithvar(0,l1)) : false;
-		c2 = l2 ? bdd_sat(constantNames & fdd_ithvar(0,l2)) : false;
-		// if they are the same value, they must alias
-		if (v1 == v2) return MustAlias;
-		// if they are both constants or not pointers, they won't alias (they are different)
-		if ((c1 || !p1) && (c2 || !p2)) return NoAlias;
-		// if everything -> everything, they may alias
-		if (pointsTo(TopLevelPTS,0,0)) return MayAlias;
-		// if the two locations are not mapped, they won't alias (they are different)
-		if (l1 == 0 && l2 == 0) return NoAlias;
-		// if either value points everywhere, they may alias
-		else if (l1 != 0 && pointsTo(TopLevelPTS,l1,0)) return MayAlias;
-		else if (l2 != 0 && pointsTo(TopLevelPTS,l2,0)) return MayAlias;
-		// if one is a constant or pointer, check if the other points to it
-		if ((c1 || !p1) && pointsTo(TopLevelPTS,l2,l1)) return MayAlias;
-		if ((c2 || !p2) && pointsTo(TopLevelPTS,l1,l2)) return MayAlias;
-		// otherwise, check if their points-to sets overlap
-		return aliasCheck(l1,l2);
-	}
+	/// alias - answered from the points-to rows, memoized in AliasCache
+	virtual AliasResult alias(const Location &LocA, const Location &LocB);
 
-	virtual ModRefBehavior getModRefBehavior(ImmutableCallSite CS) {
-		return UnknownModRefBehavior;
-	}
+	/// aliasBatch - answer alias(pairs[i].first, pairs[i].second) into
+	/// results[i] for every pair at once; the points-to rows involved are
+	/// turned into compact bitsets, so each row comparison is a word-wise AND
+	virtual void aliasBatch(const std::vector<std::pair<const Value*,const Value*> > &pairs,
+			std::vector<AliasResult> &results);
 
-	virtual ModRefBehavior getModRefBehavior(const Function *F) {
-		return UnknownModRefBehavior;
-	}
+	/// aliasMatrix - answer alias(values[i], values[j]) into
+	/// matrix[i*values.size()+j] for every i and j
+	virtual void aliasMatrix(const std::vector<const Value*> &values, std::vector<AliasResult> &matrix);
+
+	/// pointsToAt - the locations a pointer stored at Loc may point to just
+	/// before I (0 means anything); false unless run with -fsaa-keep-sets,
+	/// and for functions whose calls apply a summary
+	bool pointsToAt(const Location &Loc, const Instruction *I, std::vector<unsigned> &pointees);
+
+	/// aliasAt - may the pointers stored at LocA and LocB just before I alias
+	AliasResult aliasAt(const Location &LocA, const Location &LocB, const Instruction *I);
 
-	virtual bool pointsToConstantMemory(const Location &Loc, bool OrLocal) {
-		return false;
+	/// releaseMemory - drop the sets kept for program point queries
+	virtual void releaseMemory() {
+		if (SetsKept) releaseSets();
 	}
 
-	virtual ModRefResult getModRefInfo(ImmutableCallSite CS, const Location &Loc) {
-		return ModRef;
+	/// getModRefBehavior - from the read/write sets of the called function
+	virtual ModRefBehavior getModRefBehavior(ImmutableCallSite CS) {
+		return AliasAnalysis::getModRefBehavior(CS);
 	}
+	virtual ModRefBehavior getModRefBehavior(const Function *F);
+
+	/// pointsToConstantMemory - true if every location Loc.Ptr points to is constant
+	virtual bool pointsToConstantMemory(const Location &Loc, bool OrLocal);
+
+	/// getModRefInfo - does the called function read or write what Loc points to
+	virtual ModRefResult getModRefInfo(ImmutableCallSite CS, const Location &Loc);
 
 	virtual ModRefResult getModRefInfo(ImmutableCallSite CS1, ImmutableCallSite CS2) {
-		return ModRef;
+		return AliasAnalysis::getModRefInfo(CS1,CS2);
 	}
 
 	/// getAdjustedAnalysisPointer - This method is used when a pass implements
@@ -247,8 +484,10 @@ public:
 
 	// helper functions for process call
 	std::vector<const Function*> computeTargets(bdd *tpts, SEGNode *sn, int funId, bdd funName, Type *funType);
-	void processTarget(bdd *tpts, SEGNode *funNode, bdd filter, const Function *target);
+	void processTarget(bdd *tpts, SEGNode *funNode, CallData *cd, std::vector<bdd> &argpts, bdd filter, const Function *target);
 	bdd matchingFunctions(const Value *funCall);
+	int processLibCall(bdd *tpts, SEGNode *sn, const Function *f);
+	bdd libCallArgPointees(bdd *tpts, SEGNode *sn, int n);
 
 	// Propagation functions automate pushing BDD changes through the SEG and worklists
 	bool propagateTopLevel(bdd *oldtpts, bdd *newpart, llvm::SEGNode *sn);
@@ -264,7 +503,7 @@ public:
 	int processUndef(bdd *tpts, llvm::SEGNode *sn);
 };
 
-std::map<unsigned int,std::string*> *reverseMap(std::map<const Value*,unsigned int> *m);
+std::map<unsigned int,std::string*> *reverseMap(std::map<const Value*,unsigned int> *m, std::set<const Value*> *heaps = NULL);
 void printReverseMap(std::map<unsigned int,std::string*> *m);
 
 #endif /* FSAANALYSIS_H */
@@ -0,0 +1,282 @@
+//===- fsaa-gen.cpp - Generate synthetic modules to stress fs-aa -----------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Writes an LLVM 3.4 assembly module whose shape is set on the command line,
+// so the solver can be timed on inputs of any size. Every function has the
+// same type, i32* (i32*, i32**), so any of them can be called indirectly:
+//
+//   -functions=N   functions in the module                       (default 10)
+//   -locals=N      pointer slots (i32** allocas) per function    (default 8)
+//   -stmts=N       loads and stores per function                 (default 50)
+//   -calls=N       direct calls per function                     (default 2)
+//   -indirect=N    indirect calls per function                   (default 1)
+//   -fanout=N      functions each indirect call may reach        (default 2)
+//   -globals=N     scalar globals, and pointer globals
+//                  initialized to point at them                  (default 4)
+//   -depth=N       loop nest the statements are spread over      (default 1)
+//   -seed=N        seed; equal options and seed give equal output (default 1)
+//   -o=file        write there instead of stdout
+//
+// The module has about functions * (stmts + calls + indirect) statements,
+// so -functions=100 -stmts=10 and -functions=10000 -stmts=100 span 1k to
+// 1M. Run it through fs-aa as it is, or through llvm-as first.
+//
+//===----------------------------------------------------------------------===//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#define FNTY "i32* (i32*, i32**)"
+
+/// Options - the shape of the module
+struct Options {
+	unsigned Functions, Locals, Stmts, Calls, Indirect, Fanout, Globals, Depth;
+	uint64_t Seed;
+	const char *Output;
+	Options() : Functions(10), Locals(8), Stmts(50), Calls(2), Indirect(1), Fanout(2),
+		Globals(4), Depth(1), Seed(1), Output(NULL) {}
+};
+
+/// Generator - writes one module; a private xorshift generator keeps the
+/// output the same on every platform and C library
+class Generator {
+private:
+	const Options &Opts;
+	FILE *Out;
+	uint64_t State;
+	/// per function: the next value number, the current block, the number of
+	/// indirect call slots
+	unsigned NextValue;
+	std::string Block;
+
+	unsigned random(unsigned n) {
+		State ^= State << 13;
+		State ^= State >> 7;
+		State ^= State << 17;
+		return n ? (unsigned)(State % n) : 0;
+	}
+
+	std::string value() {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%%v%u", NextValue++);
+		return buf;
+	}
+
+	std::string label(const char *kind, unsigned n) {
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%s%u", kind, n);
+		return buf;
+	}
+
+	void startBlock(const std::string &name) {
+		fprintf(Out, "%s:\n", name.c_str());
+		Block = name;
+	}
+
+	/// a pointer to an i32 the function can store: a local scalar, a global
+	/// or the pointer argument
+	std::string target() {
+		char buf[32];
+		unsigned k = random(3);
+		if (k == 0 && Opts.Globals) snprintf(buf, sizeof(buf), "@g%u", random(Opts.Globals));
+		else if (k == 1) snprintf(buf, sizeof(buf), "%%a0");
+		else snprintf(buf, sizeof(buf), "%%s%u", random(Opts.Locals));
+		return buf;
+	}
+
+	/// a slot holding an i32*: a local, a pointer global or the argument
+	std::string slot() {
+		char buf[32];
+		unsigned k = random(8);
+		if (k == 0 && Opts.Globals) snprintf(buf, sizeof(buf), "@p%u", random(Opts.Globals));
+		else if (k == 1) snprintf(buf, sizeof(buf), "%%a1");
+		else snprintf(buf, sizeof(buf), "%%l%u", random(Opts.Locals));
+		return buf;
+	}
+
+	/// one load or store: copy a slot to a slot, or store a target
+	void memoryStatement() {
+		if (random(2)) {
+			std::string v = value();
+			fprintf(Out, "\t%s = load i32** %s\n", v.c_str(), slot().c_str());
+			fprintf(Out, "\tstore i32* %s, i32** %s\n", v.c_str(), slot().c_str());
+		} else {
+			// draw in a fixed order, argument evaluation order is unspecified
+			std::string t = target(), s = slot();
+			fprintf(Out, "\tstore i32* %s, i32** %s\n", t.c_str(), s.c_str());
+		}
+	}
+
+	void directCall() {
+		std::string p = value(), r = value();
+		fprintf(Out, "\t%s = load i32** %s\n", p.c_str(), slot().c_str());
+		unsigned callee = random(Opts.Functions);
+		std::string s = slot();
+		fprintf(Out, "\t%s = call i32* @f%u(i32* %s, i32** %s)\n", r.c_str(),
+			callee, p.c_str(), s.c_str());
+		fprintf(Out, "\tstore i32* %s, i32** %s\n", r.c_str(), slot().c_str());
+	}
+
+	/// store one of fanout functions into fp on each arm of a switch, then
+	/// call through it
+	void indirectCall(unsigned fp) {
+		std::string sel = value(), f = value(), p = value(), r = value();
+		unsigned n = Opts.Fanout ? Opts.Fanout : 1, site = NextValue;
+		fprintf(Out, "\t%s = load i32* @sel\n", sel.c_str());
+		fprintf(Out, "\tswitch i32 %s, label %%c%u.0 [", sel.c_str(), site);
+		for (unsigned i = 1; i < n; i++)
+			fprintf(Out, "%s i32 %u, label %%c%u.%u", i > 1 ? "\n\t\t" : "", i, site, i);
+		fprintf(Out, "]\n");
+		for (unsigned i = 0; i < n; i++) {
+			char name[32];
+			snprintf(name, sizeof(name), "c%u.%u", site, i);
+			startBlock(name);
+			fprintf(Out, "\tstore " FNTY "* @f%u, " FNTY "** %%fp%u\n", random(Opts.Functions), fp);
+			fprintf(Out, "\tbr label %%c%u.join\n", site);
+		}
+		startBlock(label("c", site) + ".join");
+		fprintf(Out, "\t%s = load " FNTY "** %%fp%u\n", f.c_str(), fp);
+		fprintf(Out, "\t%s = load i32** %s\n", p.c_str(), slot().c_str());
+		fprintf(Out, "\t%s = call i32* %s(i32* %s, i32** %s)\n", r.c_str(), f.c_str(), p.c_str(), slot().c_str());
+		fprintf(Out, "\tstore i32* %s, i32** %s\n", r.c_str(), slot().c_str());
+	}
+
+	/// the statements of loop level d (or of the whole body without loops),
+	/// with calls mixed in at random positions
+	void chunk(unsigned stmts, unsigned calls, unsigned indirect, unsigned &fp) {
+		unsigned total = stmts + calls + indirect;
+		for (unsigned i = 0; i < total; i++) {
+			unsigned k = random(total - i);
+			if (k < calls) { directCall(); calls--; }
+			else if (k < calls + indirect) { indirectCall(fp++); indirect--; }
+			else memoryStatement();
+		}
+	}
+
+	/// spread n over parts pieces, the earlier ones taking the remainder
+	static unsigned share(unsigned n, unsigned parts, unsigned i) {
+		return n / parts + (i < n % parts ? 1 : 0);
+	}
+
+	void function(unsigned f) {
+		unsigned levels = Opts.Depth ? Opts.Depth : 1, fp = 0;
+		NextValue = 0;
+		fprintf(Out, "define i32* @f%u(i32* %%a0, i32** %%a1) {\n", f);
+		startBlock("entry");
+		for (unsigned i = 0; i < Opts.Locals; i++) {
+			fprintf(Out, "\t%%s%u = alloca i32\n", i);
+			fprintf(Out, "\t%%l%u = alloca i32*\n", i);
+		}
+		for (unsigned i = 0; i < Opts.Indirect; i++)
+			fprintf(Out, "\t%%fp%u = alloca " FNTY "*\n", i);
+		// every slot starts out pointing somewhere
+		for (unsigned i = 0; i < Opts.Locals; i++)
+			fprintf(Out, "\tstore i32* %s, i32** %%l%u\n", target().c_str(), i);
+		if (Opts.Depth == 0) {
+			chunk(Opts.Stmts, Opts.Calls, Opts.Indirect, fp);
+		} else {
+			std::string pred = Block;
+			for (unsigned d = 0; d < levels; d++) {
+				fprintf(Out, "\tbr label %%h%u\n", d);
+				startBlock(label("h", d));
+				fprintf(Out, "\t%%i%u = phi i32 [ 0, %%%s ], [ %%n%u, %%latch%u ]\n", d, pred.c_str(), d, d);
+				fprintf(Out, "\t%%t%u = icmp slt i32 %%i%u, 10\n", d, d);
+				fprintf(Out, "\tbr i1 %%t%u, label %%b%u, label %%x%u\n", d, d, d);
+				startBlock(label("b", d));
+				chunk(share(Opts.Stmts, levels, d), share(Opts.Calls, levels, d),
+					share(Opts.Indirect, levels, d), fp);
+				pred = Block;
+			}
+			fprintf(Out, "\tbr label %%latch%u\n", levels-1);
+			for (unsigned d = levels; d-- > 0; ) {
+				startBlock(label("latch", d));
+				fprintf(Out, "\t%%n%u = add i32 %%i%u, 1\n", d, d);
+				fprintf(Out, "\tbr label %%h%u\n", d);
+				startBlock(label("x", d));
+				if (d > 0) fprintf(Out, "\tbr label %%latch%u\n", d-1);
+			}
+		}
+		std::string r = value();
+		fprintf(Out, "\t%s = load i32** %s\n", r.c_str(), slot().c_str());
+		fprintf(Out, "\tret i32* %s\n}\n\n", r.c_str());
+	}
+
+public:
+	Generator(const Options &o, FILE *out) : Opts(o), Out(out), State(o.Seed * 2654435761ULL + 1), NextValue(0) {}
+
+	void module() {
+		unsigned levels = Opts.Depth ? Opts.Depth : 1;
+		unsigned long stmts = (unsigned long)Opts.Functions * (Opts.Stmts + Opts.Calls + Opts.Indirect);
+		fprintf(Out, "; generated by fsaa-gen -functions=%u -locals=%u -stmts=%u -calls=%u -indirect=%u"
+			" -fanout=%u -globals=%u -depth=%u -seed=%llu\n", Opts.Functions, Opts.Locals, Opts.Stmts,
+			Opts.Calls, Opts.Indirect, Opts.Fanout, Opts.Globals, Opts.Depth, (unsigned long long)Opts.Seed);
+		fprintf(Out, "; about %lu statements, in loops %u deep\n\n", stmts, Opts.Depth ? levels : 0);
+		fprintf(Out, "@sel = global i32 0\n");
+		for (unsigned i = 0; i < Opts.Globals; i++)
+			fprintf(Out, "@g%u = global i32 %u\n", i, i);
+		for (unsigned i = 0; i < Opts.Globals; i++)
+			fprintf(Out, "@p%u = global i32* @g%u\n", i, random(Opts.Globals));
+		fprintf(Out, "\n");
+		for (unsigned f = 0; f < Opts.Functions; f++)
+			function(f);
+		// main enters the call graph at f0
+		fprintf(Out, "define i32 @main() {\nentry:\n");
+		fprintf(Out, "\t%%s = alloca i32\n\t%%l = alloca i32*\n");
+		fprintf(Out, "\tstore i32* %%s, i32** %%l\n");
+		fprintf(Out, "\t%%r = call i32* @f0(i32* %%s, i32** %%l)\n");
+		fprintf(Out, "\tret i32 0\n}\n");
+	}
+};
+
+// parse -name=value into an unsigned option
+static bool option(const char *arg, const char *name, unsigned &v) {
+	size_t n = strlen(name);
+	char *end;
+	if (strncmp(arg, name, n) != 0 || arg[n] != '=') return false;
+	v = strtoul(arg + n + 1, &end, 10);
+	if (*end != '\0') {
+		fprintf(stderr, "fsaa-gen: bad number in %s\n", arg);
+		exit(2);
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	Options opts;
+	unsigned seed = 1;
+	FILE *out = stdout;
+	for (int i = 1; i < argc; i++) {
+		const char *a = argv[i];
+		if (option(a, "-functions", opts.Functions) || option(a, "-locals", opts.Locals) ||
+				option(a, "-stmts", opts.Stmts) || option(a, "-calls", opts.Calls) ||
+				option(a, "-indirect", opts.Indirect) || option(a, "-fanout", opts.Fanout) ||
+				option(a, "-globals", opts.Globals) || option(a, "-depth", opts.Depth))
+			continue;
+		if (option(a, "-seed", seed)) opts.Seed = seed;
+		else if (strncmp(a, "-o=", 3) == 0) opts.Output = a + 3;
+		else {
+			fprintf(stderr, "Usage: fsaa-gen [-functions=N] [-locals=N] [-stmts=N] [-calls=N]\n"
+				"                [-indirect=N] [-fanout=N] [-globals=N] [-depth=N] [-seed=N] [-o=file]\n");
+			return 2;
+		}
+	}
+	if (opts.Functions == 0 || opts.Locals == 0) {
+		fprintf(stderr, "fsaa-gen: -functions and -locals must be at least 1\n");
+		return 2;
+	}
+	if (opts.Output != NULL && (out = fopen(opts.Output, "w")) == NULL) {
+		fprintf(stderr, "fsaa-gen: cannot write %s\n", opts.Output);
+		return 1;
+	}
+	Generator(opts, out).module();
+	if (out != stdout) fclose(out);
+	return 0;
+}
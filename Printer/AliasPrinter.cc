@@ -6,7 +6,9 @@
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/IR/Module.h"
+#include "llvm/PassRegistry.h"
 #include "llvm/Support/Debug.h"
+#include "../FSAAnalysis.h"
 
 using namespace llvm;
 
@@ -14,6 +16,8 @@ class AliasPrinter : public ModulePass {
 
 	// alias analysis used to print out which value pairs alias
 	AliasAnalysis *AA;
+	// fs-aa, if it is running, answers whole lists of queries at once
+	FlowSensitiveAliasAnalysis *FSAA;
 	// set stores every global LLVM value
 	std::set<const Value*> G;
 	// map stores every value defined in a function
@@ -34,6 +38,7 @@ class AliasPrinter : public ModulePass {
 	virtual bool runOnModule(Module &M) {
 		// get alias information
 		AA = &getAnalysis<AliasAnalysis>();
+		FSAA = findFSAA();
 		// build value vector
 		enumerateValues(M);
 		// print out alias results here
@@ -84,25 +89,59 @@ class AliasPrinter : public ModulePass {
 		}
 	}
 
+	// look fs-aa up by name, it lives in another loadable module
+	FlowSensitiveAliasAnalysis *findFSAA() {
+		const PassInfo *PI = PassRegistry::getPassRegistry()->getPassInfo("fs-aa");
+		Pass *P;
+		if (PI == NULL) return NULL;
+		P = getResolver()->getAnalysisIfAvailable(PI->getTypeInfo(),true);
+		if (P == NULL) return NULL;
+		return (FlowSensitiveAliasAnalysis*)P->getAdjustedAnalysisPointer(PI->getTypeInfo());
+	}
+
+	// answer a list of queries, in one batch if fs-aa is there
+	void queryPairs(std::vector<std::pair<const Value*,const Value*> > &pairs,
+			std::vector<AliasAnalysis::AliasResult> &results) {
+		if (FSAA != NULL) {
+			FSAA->aliasBatch(pairs,results);
+			return;
+		}
+		results.resize(pairs.size());
+		for (unsigned i = 0; i < pairs.size(); i++)
+			results[i] = AA->alias(pairs[i].first,pairs[i].second);
+	}
+
 	// print aliasable values through the whole program
 	#define VOID(v) (*v)->getType()->isVoidTy()
 	void printInterFunctionAliases() {
-		std::set<const Value*>::iterator i1,i2,ve;
-		// exploit symmetric nature of relation, only print out one side
-		ve = W.end();
-		for (i1 = W.begin(); i1 != ve; ++i1) {
-			for (i2 = i1; i2 != ve; ++i2) {
-				// skip this is values are void or if they are identical
-				if (*i1 == *i2 || VOID(i1) || VOID(i2)) continue;
-				printMapping(AA->alias(*i1,*i2),*i1,*i2);
-			}
+		std::vector<AliasAnalysis::AliasResult> results;
+		std::vector<const Value*> values;
+		std::set<const Value*>::iterator vi,ve;
+		unsigned n;
+		// skip void values
+		for (vi = W.begin(), ve = W.end(); vi != ve; ++vi)
+			if (!VOID(vi)) values.push_back(*vi);
+		n = values.size();
+		// ask for the whole matrix at once if we can
+		if (FSAA != NULL) FSAA->aliasMatrix(values,results);
+		else {
+			results.resize(n * n);
+			for (unsigned i = 0; i < n; i++)
+				for (unsigned j = i+1; j < n; j++)
+					results[i*n+j] = AA->alias(values[i],values[j]);
 		}
+		// exploit symmetric nature of relation, only print out one side
+		for (unsigned i = 0; i < n; i++)
+			for (unsigned j = i+1; j < n; j++)
+				printMapping(results[i*n+j],values[i],values[j]);
 	}
 
 	// print aliasable values per function
 	void printIntraFunctionAliases() {
 		std::map<const Function*,std::set<const Value*>*>::iterator fi,fe;
 		std::set<const Value*>::iterator i1,i2,ve,ge;
+		std::vector<std::pair<const Value*,const Value*> > pairs;
+		std::vector<AliasAnalysis::AliasResult> results;
 		ge = G.end();
 		// iterate over each function
 		for (fi = F.begin(), fe = F.end(); fi != fe; ++fi) {
@@ -112,22 +151,26 @@ class AliasPrinter : public ModulePass {
 				// other function values?
 				for (i2 = i1; i2 != ve; ++i2) {
 					if (*i1 == *i2 || VOID(i1) || VOID(i2)) continue;
-					printMapping(AA->alias(*i1,*i2),*i1,*i2);
+					pairs.push_back(std::make_pair(*i1,*i2));
 				}
 				// global values?
-				for (i2 = G.begin(); i2 != ge; ++i2)
+				for (i2 = G.begin(); i2 != ge; ++i2) {
 					if (*i1 == *i2 || VOID(i1) || VOID(i2)) continue;
-					printMapping(AA->alias(*i1,*i2),*i1,*i2);
+					pairs.push_back(std::make_pair(*i1,*i2));
+				}
 			}
 		}
 		// check if globals alias each other
-		ge = G.end();
 		for (i1 = G.begin(); i1 != ge; ++i1) {
 			for (i2 = i1; i2 != ge; ++i2) {
 					if (*i1 == *i2 || VOID(i1) || VOID(i2)) continue;
-					printMapping(AA->alias(*i1,*i2),*i1,*i2);
+					pairs.push_back(std::make_pair(*i1,*i2));
 			}
 		}
+		// ask everything at once, then print in the same order
+		queryPairs(pairs,results);
+		for (unsigned i = 0; i < pairs.size(); i++)
+			printMapping(results[i],pairs[i].first,pairs[i].second);
 	}
 
 	// print out an alias mapping
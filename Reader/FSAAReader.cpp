@@ -0,0 +1,122 @@
+//===- FSAAReader.cpp - Read exported fs-aa results in place --------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAReader.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// does a section of count elements of size bytes at off lie inside the file
+static bool inside(uint64_t off, uint64_t count, uint64_t size, size_t fileSize) {
+	return off <= fileSize && count <= (fileSize - off) / (size ? size : 1);
+}
+
+// do the offsets and ranges inside the sections agree with the counts; the
+// sections themselves must already have been checked to lie in the file
+static bool consistent(const FSAAExportHeader *h, const char *base) {
+	const uint32_t *names = (const uint32_t*)(base + h->NameOffsets);
+	const uint32_t *offsets = (const uint32_t*)(base + h->PtsOffsets);
+	const FSAAExportFunction *funcs = (const FSAAExportFunction*)(base + h->Functions);
+	const uint32_t *targets = (const uint32_t*)(base + h->PtsTargets);
+	const uint32_t *accesses = (const uint32_t*)(base + h->Accesses);
+	uint32_t strings = names[h->LocationCount];
+	// every name starts inside the strings, which end with a NUL
+	if (strings != 0 && base[h->Strings + strings - 1] != '\0') return false;
+	for (uint32_t i = 0; i < h->LocationCount; i++)
+		if (names[i] >= strings) return false;
+	// rows follow each other without gaps, from the first target to the last
+	if (offsets[0] != 0) return false;
+	for (uint32_t i = 0; i < h->LocationCount; i++)
+		if (offsets[i] > offsets[i+1]) return false;
+	if (offsets[h->LocationCount] != h->PtsTargetCount) return false;
+	// every target and every access names a location
+	for (uint32_t i = 0; i < h->PtsTargetCount; i++)
+		if (targets[i] >= h->LocationCount) return false;
+	for (uint32_t i = 0; i < h->AccessCount; i++)
+		if (accesses[i] >= h->LocationCount) return false;
+	for (uint32_t i = 0; i < h->FunctionCount; i++) {
+		const FSAAExportFunction &f = funcs[i];
+		if (f.Id >= h->LocationCount ||
+				f.ReadsBegin > f.ReadsEnd || f.ReadsEnd > h->AccessCount ||
+				f.WritesBegin > f.WritesEnd || f.WritesEnd > h->AccessCount)
+			return false;
+	}
+	return true;
+}
+
+bool FSAAResults::open(const char *path, std::string &error) {
+	struct stat st;
+	const FSAAExportHeader *h;
+	void *map;
+	int fd;
+	close();
+	if ((fd = ::open(path,O_RDONLY)) < 0) {
+		error = std::string("cannot open ") + path + ": " + strerror(errno);
+		return false;
+	}
+	if (fstat(fd,&st) < 0 || (size_t)st.st_size < sizeof(FSAAExportHeader)) {
+		error = std::string(path) + ": too short for an fs-aa export";
+		::close(fd);
+		return false;
+	}
+	map = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	::close(fd);
+	if (map == MAP_FAILED) {
+		error = std::string("cannot map ") + path + ": " + strerror(errno);
+		return false;
+	}
+	Base = (const char*)map;
+	Size = st.st_size;
+	h = header();
+	// check we can read this file, and that every section is where it says
+	if (strncmp(h->Magic,FSAA_EXPORT_MAGIC,sizeof(h->Magic)) != 0)
+		error = std::string(path) + ": not an fs-aa export";
+	else if (h->ByteOrder != FSAA_EXPORT_BYTEORDER)
+		error = std::string(path) + ": written with a different byte order";
+	else if (h->Version != FSAA_EXPORT_VERSION)
+		error = std::string(path) + ": unsupported version";
+	else if (h->FileSize != Size ||
+			!inside(h->NameOffsets,h->LocationCount+1ULL,sizeof(uint32_t),Size) ||
+			!inside(h->PtsOffsets,h->LocationCount+1ULL,sizeof(uint32_t),Size) ||
+			!inside(h->PtsTargets,h->PtsTargetCount,sizeof(uint32_t),Size) ||
+			!inside(h->LocFlags,h->LocationCount,sizeof(uint8_t),Size) ||
+			!inside(h->Functions,h->FunctionCount,sizeof(FSAAExportFunction),Size) ||
+			!inside(h->Accesses,h->AccessCount,sizeof(uint32_t),Size) ||
+			!inside(h->Strings,section<uint32_t>(h->NameOffsets)[h->LocationCount],1,Size) ||
+			!consistent(h,Base))
+		error = std::string(path) + ": truncated or corrupt";
+	else return true;
+	close();
+	return false;
+}
+
+void FSAAResults::close() {
+	if (Base != NULL) munmap((void*)Base,Size);
+	Base = NULL;
+	Size = 0;
+}
+
+long FSAAResults::find(const char *n) const {
+	for (uint32_t i = 0; i < locationCount(); i++)
+		if (strcmp(name(i),n) == 0) return i;
+	return -1;
+}
+
+bool FSAAResults::mayAlias(uint32_t a, uint32_t b) const {
+	const uint32_t *i1 = pointeesBegin(a), *e1 = pointeesEnd(a);
+	const uint32_t *i2 = pointeesBegin(b), *e2 = pointeesEnd(b);
+	if (pointsEverywhere(a) || pointsEverywhere(b)) return true;
+	while (i1 != e1 && i2 != e2) {
+		if (*i1 < *i2) ++i1;
+		else if (*i2 < *i1) ++i2;
+		else return true;
+	}
+	return false;
+}
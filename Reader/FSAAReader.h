@@ -0,0 +1,81 @@
+//===- FSAAReader.h - Read exported fs-aa results in place ----------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// FSAAResults maps a file written with -fsaa-export and answers queries
+// straight from the mapping; nothing is parsed or copied. It needs neither
+// LLVM nor the BDD library.
+//
+//===----------------------------------------------------------------------===//
+#ifndef FSAA_READER_H
+#define FSAA_READER_H
+
+#include "../FSAAExportFormat.h"
+#include <cstddef>
+#include <string>
+
+class FSAAResults {
+private:
+	/// Base/Size - the mapping of the whole file
+	const char *Base;
+	size_t Size;
+
+	const FSAAExportHeader *header() const {
+		return (const FSAAExportHeader*)Base;
+	}
+	template <typename T> const T *section(uint64_t off) const {
+		return (const T*)(Base + off);
+	}
+
+public:
+	FSAAResults() : Base(NULL), Size(0) {}
+	~FSAAResults() { close(); }
+
+	/// open - map a file and check its header; on failure, error says why
+	bool open(const char *path, std::string &error);
+	void close();
+
+	uint32_t version() const       { return header()->Version;       }
+	uint32_t locationCount() const { return header()->LocationCount; }
+	uint32_t functionCount() const { return header()->FunctionCount; }
+
+	/// name - the name of id, "" if it has none
+	const char *name(uint32_t id) const {
+		return section<char>(header()->Strings) + section<uint32_t>(header()->NameOffsets)[id];
+	}
+
+	/// find - the id named name, or -1 (a linear scan)
+	long find(const char *name) const;
+
+	/// pointees - the sorted locations id points to, without 0 (everything)
+	const uint32_t *pointeesBegin(uint32_t id) const {
+		return section<uint32_t>(header()->PtsTargets) + section<uint32_t>(header()->PtsOffsets)[id];
+	}
+	const uint32_t *pointeesEnd(uint32_t id) const {
+		return section<uint32_t>(header()->PtsTargets) + section<uint32_t>(header()->PtsOffsets)[id+1];
+	}
+
+	bool pointsEverywhere(uint32_t id) const {
+		return section<uint8_t>(header()->LocFlags)[id] & FSAA_LOC_EVERYWHERE;
+	}
+	bool isConstant(uint32_t id) const {
+		return section<uint8_t>(header()->LocFlags)[id] & FSAA_LOC_CONSTANT;
+	}
+
+	/// mayAlias - do the points-to sets of two ids overlap
+	bool mayAlias(uint32_t a, uint32_t b) const;
+
+	/// function - the i-th function of the module, and its read/write sets
+	const FSAAExportFunction &function(uint32_t i) const {
+		return section<FSAAExportFunction>(header()->Functions)[i];
+	}
+	const uint32_t *accesses(uint32_t begin) const {
+		return section<uint32_t>(header()->Accesses) + begin;
+	}
+};
+
+#endif /* FSAA_READER_H */
@@ -0,0 +1,78 @@
+//===- fsaa-dump.cpp - Print or query exported fs-aa results ---------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// fsaa-dump file             print every points-to row and function
+// fsaa-dump file name...     print the rows of the named values, and whether
+//                            each pair of them may alias
+//
+//===----------------------------------------------------------------------===//
+#include "FSAAReader.h"
+#include <cstdio>
+#include <vector>
+
+// print a single points-to row
+static void printRow(const FSAAResults &r, uint32_t id) {
+	printf("%s ->", r.name(id));
+	if (r.pointsEverywhere(id)) printf(" %s", r.name(0));
+	for (const uint32_t *p = r.pointeesBegin(id); p != r.pointeesEnd(id); ++p)
+		printf(" %s", r.name(*p));
+	printf("%s\n", r.isConstant(id) ? " (constant)" : "");
+}
+
+// print a function's read or write set
+static void printAccesses(const FSAAResults &r, const char *what, bool any, uint32_t begin, uint32_t end) {
+	printf("  %s:", what);
+	if (any) printf(" %s", r.name(0));
+	for (const uint32_t *p = r.accesses(begin); p != r.accesses(end); ++p)
+		printf(" %s", r.name(*p));
+	printf("\n");
+}
+
+int main(int argc, char **argv) {
+	FSAAResults r;
+	std::string error;
+	std::vector<uint32_t> ids;
+	if (argc < 2) {
+		fprintf(stderr, "Usage: fsaa-dump file [name...]\n");
+		return 2;
+	}
+	if (!r.open(argv[1], error)) {
+		fprintf(stderr, "fsaa-dump: %s\n", error.c_str());
+		return 1;
+	}
+	// whole file
+	if (argc == 2) {
+		printf("VERSION %u, %u LOCATIONS, %u FUNCTIONS\n", r.version(), r.locationCount(), r.functionCount());
+		for (uint32_t i = 0; i < r.locationCount(); i++)
+			if (r.pointsEverywhere(i) || r.pointeesBegin(i) != r.pointeesEnd(i))
+				printRow(r, i);
+		for (uint32_t i = 0; i < r.functionCount(); i++) {
+			const FSAAExportFunction &f = r.function(i);
+			printf("FUNCTION %s%s\n", r.name(f.Id), f.Flags & FSAA_FUNC_DEFINED ? "" : " (declaration)");
+			if (!(f.Flags & FSAA_FUNC_DEFINED)) continue;
+			printAccesses(r, "READS", f.Flags & FSAA_FUNC_READS_ANY, f.ReadsBegin, f.ReadsEnd);
+			printAccesses(r, "WRITES", f.Flags & FSAA_FUNC_WRITES_ANY, f.WritesBegin, f.WritesEnd);
+		}
+		return 0;
+	}
+	// named values
+	for (int i = 2; i < argc; i++) {
+		long id = r.find(argv[i]);
+		if (id < 0) {
+			fprintf(stderr, "fsaa-dump: no value named %s\n", argv[i]);
+			return 1;
+		}
+		ids.push_back(id);
+		printRow(r, id);
+	}
+	for (unsigned i = 0; i < ids.size(); i++)
+		for (unsigned j = i+1; j < ids.size(); j++)
+			printf("%s : %s : %s\n", r.mayAlias(ids[i], ids[j]) ? "MAY " : "NONE",
+				r.name(ids[i]), r.name(ids[j]));
+	return 0;
+}
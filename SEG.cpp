@@ -28,7 +28,7 @@ STATISTIC(CallSites,	"Call Sites: The # of Call/Invoke instructions");
 
 using namespace llvm;
 
-SEG::SEG(const Function *fn) : Fn(fn){
+SEG::SEG(const Function *fn) : Fn(fn), Index(0) {
 	IsDeclaration = fn->isDeclaration();
 	if(IsDeclaration)
 		return;
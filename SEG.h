@@ -34,6 +34,8 @@ class SEG {
 private:
 	const Function *Fn;
 	bool IsDeclaration;
+	/// Index - dense number of this SEG, indexes all per-function tables
+	unsigned Index;
 
 	SEGNode *EntryNode;	
 	/// List of SEGNode in function
@@ -50,6 +52,8 @@ public:
 	/// getFunction - Return LLVM Function this SEG represents for.
 	const Function *getFunction() { return Fn; }
 	bool isDeclaration() { return IsDeclaration; }
+	unsigned getIndex() { return Index; }
+	void setIndex(unsigned i) { Index = i; }
 
 	/// extend given InstNodeMap by this SEG
 	InstNodeMap *extendInstNodeMap(InstNodeMap* im);	
@@ -32,6 +32,7 @@ SEGNode::SEGNode(SEG *parent) : Inst(NULL), Parent(parent) {
 	Extra = NULL;
 	LoadDefined = true;
 	StoreUndefined = false;
+	Queued = false;
 #ifdef ENABLE_OPT_1
 	SingleCopy = false;
 	Source = NULL;
@@ -51,6 +52,7 @@ SEGNode::SEGNode(const Instruction * inst, SEG *parent) : Inst(inst), Parent(par
 	Extra = NULL;
 	LoadDefined = true;
 	StoreUndefined = false;
+	Queued = false;
 #ifdef ENABLE_OPT_1
 	SingleCopy = isa<GetElementPtrInst>(inst) | isa<CastInst>(inst);
 	Source = NULL;
@@ -99,12 +99,16 @@ private:
 	/// Bool to record if this is a load from an undefined value
 	bool LoadDefined;
 
+	/// Bool to record if this node is in its function's statement worklist
+	bool Queued;
+
 public:
 
 	bool StoreUndefined;
 
 	SEGNode() {
 		Defined = true;
+		Queued = false;
 		StaticData = NULL;
 		ArgIds = NULL;
 		Extra = NULL;
@@ -145,9 +149,11 @@ public:
 	std::vector<bdd> *getStaticData()                 { return StaticData;             }
 	bool getDefined()                                 { return Defined;                }
 	bool getLoadDefined()                             { return LoadDefined;            }
+	bool isQueued()                                   { return Queued;                 }
 	ExtraData *getExtraData()                         { return Extra;                  }
 	void setArgIds(std::vector<unsigned int> *ArgIds) { this->ArgIds = ArgIds;         }
 	void setId(unsigned int Id)                       { this->Id = Id;                 }
+	void setQueued(bool Queued)                       { this->Queued = Queued;         }
 	void setInSet(bdd In)                             { this->In = In;                 }
 	void setOutSet(bdd Out)                           { this->Out = Out;               }
 	void setStaticData(std::vector<bdd> *StaticData)  { this->StaticData = StaticData; }
@@ -336,7 +342,13 @@ struct CallData : public ExtraData {
 	bdd  argset;                                  // a bdd representing all argument names (a1 | a2 | a3 ... )
 	llvm::Type *funcType;                         // the type of this function (note all called functions are pointers)
 	std::vector<const llvm::Function*> targets;  // the possible targets of this call
+	std::set<const llvm::Function*> knownTargets; // targets already fully processed from this call
+	std::vector<bdd> lastArgPts;                  // argument points-to sets at the last visit
+	bdd  lastFilter;                              // filter passed to known targets so far
+	bdd  retOut;                                  // address-taken pairs returned by the targets so far
 	CallData() {
+		lastFilter = bdd_false();
+		retOut = bdd_false();
 	}
 	~CallData() {
 	}
@@ -350,8 +362,12 @@ struct RetData {
 	unsigned int callStatus; // stores NO_SAVE, UNDEF_SAVE, or DEF_SAVE
 	                         // NO_SAVE : call doesn't save ret, UNDEF_SAVE : call saves, but not defined, DEF_SAVE : call saves and defined
 	bdd saveName;            // stores bdd name for saved return value
+	bdd sentOut;             // callee outset pairs already sent to this call
+	bdd sentRet;             // returned pointees already sent to this call
 	RetData(std::map<const llvm::Value*,unsigned> *im, llvm::SEGNode *sn) {
 		callInst = sn;
+		sentOut  = bdd_false();
+		sentRet  = bdd_false();
 		const llvm::Instruction *i = sn->getInstruction();
 		// if return value is not used, I don't care about it
 		if (i->getType()->isVoidTy()) {
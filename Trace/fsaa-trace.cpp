@@ -0,0 +1,277 @@
+//===- fsaa-trace.cpp - Summarize fs-aa worklist traces --------------------===//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// fsaa-trace [-top=N] [-buckets=N] file
+//
+// Replays a trace written with -fsaa-trace and prints:
+//   - totals: pops, rounds, time, how many pops changed a set;
+//   - reprocessing: how often nodes were popped, and the nodes and
+//     functions popped most (time is up to the next record);
+//   - convergence: node pops split into -buckets equal parts, with the
+//     share that changed a set, what they queued and the new nodes seen;
+//   - the critical chain: the longest run of pops where each was queued by
+//     the transfer function of the one before it.
+//
+//===----------------------------------------------------------------------===//
+#include "../FSAATraceFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/// Trace - a whole trace file, read into memory
+struct Trace {
+	FSAATraceHeader Header;
+	std::vector<std::string> Functions, Opcodes;
+	std::vector<FSAATraceRecord> Records;
+
+	bool read(const char *path);
+
+	std::string node(const FSAATraceRecord &r) const {
+		char buf[64];
+		const char *op = r.Opcode < Opcodes.size() ? Opcodes[r.Opcode].c_str() : "?";
+		snprintf(buf, sizeof(buf), "#%u (%s)", r.Node, op);
+		return function(r.Function) + buf;
+	}
+	std::string function(uint32_t fi) const {
+		return fi < Functions.size() ? Functions[fi] : "?";
+	}
+	/// duration - from record i to the next, the last one takes no time
+	uint64_t duration(size_t i) const {
+		return i + 1 < Records.size() ? Records[i+1].Nanos - Records[i].Nanos : 0;
+	}
+};
+
+bool Trace::read(const char *path) {
+	FILE *f = fopen(path, "rb");
+	std::vector<char> names;
+	long size, start;
+	if (f == NULL) {
+		fprintf(stderr, "fsaa-trace: cannot open %s\n", path);
+		return false;
+	}
+	if (fread(&Header, sizeof(Header), 1, f) != 1 ||
+			strncmp(Header.Magic, FSAA_TRACE_MAGIC, sizeof(Header.Magic)) != 0) {
+		fprintf(stderr, "fsaa-trace: %s is not an fs-aa trace\n", path);
+		fclose(f);
+		return false;
+	}
+	if (Header.ByteOrder != FSAA_TRACE_BYTEORDER || Header.Version != FSAA_TRACE_VERSION) {
+		fprintf(stderr, "fsaa-trace: %s has another byte order or version\n", path);
+		fclose(f);
+		return false;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	start = sizeof(Header) + Header.NamesSize;
+	if (Header.NamesSize % 8 || start > size) {
+		fprintf(stderr, "fsaa-trace: %s is truncated\n", path);
+		fclose(f);
+		return false;
+	}
+	// the names, then as many whole records as there are
+	names.resize(Header.NamesSize + 1);
+	fseek(f, sizeof(Header), SEEK_SET);
+	if (fread(&names[0], 1, Header.NamesSize, f) != Header.NamesSize) {
+		fprintf(stderr, "fsaa-trace: cannot read %s\n", path);
+		fclose(f);
+		return false;
+	}
+	for (size_t p = 0; p < Header.NamesSize && Functions.size() + Opcodes.size() < Header.FunctionCount + Header.OpcodeCount; ) {
+		std::string n(&names[p]);
+		if (Functions.size() < Header.FunctionCount) Functions.push_back(n);
+		else Opcodes.push_back(n);
+		p += n.size() + 1;
+	}
+	Records.resize((size - start) / sizeof(FSAATraceRecord));
+	if (!Records.empty() && fread(&Records[0], sizeof(FSAATraceRecord), Records.size(), f) != Records.size()) {
+		fprintf(stderr, "fsaa-trace: cannot read %s\n", path);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+	return true;
+}
+
+/// Count - pops and time of a node or a function
+struct Count {
+	uint64_t Pops, Nanos;
+	size_t Last;                // a record of it, to name it by
+	Count() : Pops(0), Nanos(0), Last(0) {}
+};
+
+static bool morePops(const Count &a, const Count &b) {
+	return a.Pops != b.Pops ? a.Pops > b.Pops : a.Nanos > b.Nanos;
+}
+
+static void totals(const Trace &t) {
+	uint64_t nodes = 0, funcs = 0, rounds = 0, top = 0, out = 0, none = 0;
+	for (size_t i = 0; i < t.Records.size(); i++) {
+		const FSAATraceRecord &r = t.Records[i];
+		if (r.Kind == FSAA_TRACE_ROUND) rounds++;
+		else if (r.Kind == FSAA_TRACE_FUNCTION) funcs++;
+		else if (r.Kind == FSAA_TRACE_NODE) {
+			nodes++;
+			if (r.Flags & FSAA_TRACE_TOP_CHANGED) top++;
+			if (r.Flags & FSAA_TRACE_OUT_CHANGED) out++;
+			if (!(r.Flags & (FSAA_TRACE_TOP_CHANGED|FSAA_TRACE_OUT_CHANGED))) none++;
+		}
+	}
+	printf("TOTALS\n");
+	printf("  functions   %u\n", t.Header.FunctionCount);
+	printf("  rounds      %llu\n", (unsigned long long)rounds);
+	printf("  func pops   %llu\n", (unsigned long long)funcs);
+	printf("  node pops   %llu\n", (unsigned long long)nodes);
+	printf("  time        %.3f ms\n", t.Records.empty() ? 0.0 : t.Records.back().Nanos / 1e6);
+	printf("  top changed %llu\n", (unsigned long long)top);
+	printf("  out changed %llu\n", (unsigned long long)out);
+	printf("  no change   %llu (%.1f%%)\n", (unsigned long long)none, nodes ? 100.0 * none / nodes : 0.0);
+}
+
+static void reprocessing(const Trace &t, unsigned top) {
+	std::map<std::pair<uint32_t,uint32_t>,Count> byNode;
+	std::map<uint32_t,Count> byFunc;
+	std::vector<Count> nodes, funcs;
+	// histogram buckets: 1, 2, 3-4, 5-8, ...
+	std::vector<uint64_t> hist;
+	for (size_t i = 0; i < t.Records.size(); i++) {
+		const FSAATraceRecord &r = t.Records[i];
+		if (r.Kind != FSAA_TRACE_NODE) continue;
+		Count &n = byNode[std::make_pair(r.Function, r.Node)], &f = byFunc[r.Function];
+		n.Pops++;
+		n.Nanos += t.duration(i);
+		n.Last = i;
+		f.Pops++;
+		f.Nanos += t.duration(i);
+		f.Last = i;
+	}
+	for (std::map<std::pair<uint32_t,uint32_t>,Count>::iterator i = byNode.begin(); i != byNode.end(); ++i) {
+		unsigned b = 0;
+		for (uint64_t p = i->second.Pops - 1; p; p >>= 1) b++;
+		if (hist.size() <= b) hist.resize(b + 1, 0);
+		hist[b]++;
+		nodes.push_back(i->second);
+	}
+	for (std::map<uint32_t,Count>::iterator i = byFunc.begin(); i != byFunc.end(); ++i)
+		funcs.push_back(i->second);
+	std::sort(nodes.begin(), nodes.end(), morePops);
+	std::sort(funcs.begin(), funcs.end(), morePops);
+	printf("\nREPROCESSING (%llu distinct nodes)\n", (unsigned long long)nodes.size());
+	for (unsigned b = 0; b < hist.size(); b++) {
+		unsigned long long lo = b ? (1ULL << (b - 1)) + 1 : 1, hi = 1ULL << b;
+		char range[48];
+		if (lo == hi) snprintf(range, sizeof(range), "%llu", lo);
+		else snprintf(range, sizeof(range), "%llu-%llu", lo, hi);
+		printf("  popped %-12s times %10llu nodes\n", range, (unsigned long long)hist[b]);
+	}
+	printf("\nMOST POPPED NODES\n");
+	for (unsigned i = 0; i < nodes.size() && i < top; i++)
+		printf("  %8llu pops %10.3f ms  %s\n", (unsigned long long)nodes[i].Pops, nodes[i].Nanos / 1e6,
+			t.node(t.Records[nodes[i].Last]).c_str());
+	printf("\nMOST POPPED FUNCTIONS\n");
+	for (unsigned i = 0; i < funcs.size() && i < top; i++)
+		printf("  %8llu pops %10.3f ms  %s\n", (unsigned long long)funcs[i].Pops, funcs[i].Nanos / 1e6,
+			t.function(t.Records[funcs[i].Last].Function).c_str());
+}
+
+static void convergence(const Trace &t, unsigned buckets) {
+	std::vector<size_t> pops;
+	std::map<std::pair<uint32_t,uint32_t>,bool> seen;
+	for (size_t i = 0; i < t.Records.size(); i++)
+		if (t.Records[i].Kind == FSAA_TRACE_NODE) pops.push_back(i);
+	printf("\nCONVERGENCE\n");
+	printf("  %10s %10s %8s %10s %10s %12s\n", "pops", "end ms", "changed", "queued", "new nodes", "out bdd nodes");
+	if (pops.empty() || buckets == 0) return;
+	for (unsigned b = 0; b < buckets; b++) {
+		size_t lo = pops.size() * b / buckets, hi = pops.size() * (b + 1) / buckets;
+		uint64_t changed = 0, queued = 0, fresh = 0, outNodes = 0;
+		if (lo == hi) continue;
+		for (size_t k = lo; k < hi; k++) {
+			const FSAATraceRecord &r = t.Records[pops[k]];
+			if (r.Flags & (FSAA_TRACE_TOP_CHANGED|FSAA_TRACE_OUT_CHANGED)) changed++;
+			queued += r.Queued;
+			outNodes += r.OutNodes;
+			if (!seen[std::make_pair(r.Function, r.Node)]) {
+				seen[std::make_pair(r.Function, r.Node)] = true;
+				fresh++;
+			}
+		}
+		printf("  %10llu %10.3f %7.1f%% %10llu %10llu %12llu\n", (unsigned long long)hi,
+			t.Records[pops[hi-1]].Nanos / 1e6, 100.0 * changed / (hi - lo),
+			(unsigned long long)queued, (unsigned long long)fresh, (unsigned long long)outNodes);
+	}
+}
+
+static void criticalChain(const Trace &t, unsigned top) {
+	std::vector<uint32_t> depth(t.Records.size(), 0);
+	std::vector<size_t> chain;
+	size_t end = 0;
+	for (size_t i = 0; i < t.Records.size(); i++) {
+		const FSAATraceRecord &r = t.Records[i];
+		if (r.Kind != FSAA_TRACE_NODE) continue;
+		// causes always come earlier in the trace
+		depth[i] = r.Cause < i ? depth[r.Cause] + 1 : 1;
+		if (depth[i] > depth[end]) end = i;
+	}
+	printf("\nCRITICAL CHAIN (%u pops)\n", depth.empty() ? 0 : depth[end]);
+	if (depth.empty() || depth[end] == 0) return;
+	for (size_t i = end; ; i = t.Records[i].Cause) {
+		chain.push_back(i);
+		if (t.Records[i].Cause >= i) break;
+	}
+	std::reverse(chain.begin(), chain.end());
+	for (size_t k = 0; k < chain.size(); k++) {
+		// the start and the end of a long chain
+		if (chain.size() > 2 * top && k == top) {
+			printf("  ... %llu more ...\n", (unsigned long long)(chain.size() - 2 * top));
+			k = chain.size() - top;
+		}
+		const FSAATraceRecord &r = t.Records[chain[k]];
+		printf("  %10.3f ms  %s\n", r.Nanos / 1e6, t.node(r).c_str());
+	}
+}
+
+// parse -name=value into an unsigned option
+static bool option(const char *arg, const char *name, unsigned &v) {
+	size_t n = strlen(name);
+	if (strncmp(arg, name, n) != 0 || arg[n] != '=') return false;
+	v = strtoul(arg + n + 1, NULL, 10);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	unsigned top = 10, buckets = 20;
+	const char *path = NULL;
+	Trace t;
+	for (int i = 1; i < argc; i++) {
+		if (option(argv[i], "-top", top) || option(argv[i], "-buckets", buckets)) continue;
+		if (argv[i][0] == '-' || path != NULL) {
+			fprintf(stderr, "Usage: fsaa-trace [-top=N] [-buckets=N] file\n");
+			return 2;
+		}
+		path = argv[i];
+	}
+	if (path == NULL) {
+		fprintf(stderr, "Usage: fsaa-trace [-top=N] [-buckets=N] file\n");
+		return 2;
+	}
+	// the chain elision keeps top pops at each end
+	if (top == 0) {
+		fprintf(stderr, "fsaa-trace: -top must be at least 1\n");
+		return 2;
+	}
+	if (!t.read(path)) return 1;
+	totals(t);
+	reprocessing(t, top);
+	convergence(t, buckets);
+	criticalChain(t, top);
+	return 0;
+}
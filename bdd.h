@@ -192,6 +192,42 @@ typedef struct s_bddCacheStat
    long unsigned int swapCount;
 } bddCacheStat;
 
+
+/*
+NAME    {* bddOpCacheStat *}
+SECTION {* kernel *}
+SHORT   {* Status information about a single operator cache *}
+PROTO   {* typedef struct s_bddOpCacheStat
+{
+   int size;
+   long unsigned int hits;
+   long unsigned int misses;
+   long unsigned int evictions;
+} bddOpCacheStat; *}
+DESCR   {* Filled in by {\tt bdd\_opcachestats} for one of the caches
+           {\tt BDD\_CACHE\_APPLY}, {\tt BDD\_CACHE\_ITE},
+	   {\tt BDD\_CACHE\_QUANT}, {\tt BDD\_CACHE\_APPEX},
+	   {\tt BDD\_CACHE\_REPLACE}, {\tt BDD\_CACHE\_RESTRICT} and
+	   {\tt BDD\_CACHE\_MISC}. *}
+ALSO    {* bdd\_opcachestats, bdd\_setopcachesize *}
+*/
+typedef struct s_bddOpCacheStat
+{
+   int size;
+   long unsigned int hits;
+   long unsigned int misses;
+   long unsigned int evictions;
+} bddOpCacheStat;
+
+#define BDD_CACHE_APPLY    0
+#define BDD_CACHE_ITE      1
+#define BDD_CACHE_QUANT    2
+#define BDD_CACHE_APPEX    3   /* Also used by bdd_relprod */
+#define BDD_CACHE_REPLACE  4
+#define BDD_CACHE_RESTRICT 5
+#define BDD_CACHE_MISC     6
+#define BDD_CACHE_NUM      7
+
 /*=== BDD interface prototypes =========================================*/
 
 /*
@@ -233,6 +269,7 @@ extern int      bdd_setvarnum(int);
 extern int      bdd_extvarnum(int);
 extern int      bdd_isrunning(void);
 extern int      bdd_setmaxnodenum(int);
+extern int      bdd_setnodereserve(int);
 extern int      bdd_setmaxincrease(int);
 extern int      bdd_setminfreenodes(int);
 extern int      bdd_getnodenum(void);
@@ -274,6 +311,8 @@ extern void     bdd_freepair(bddPair*);
   /* In bddop.c */
 
 extern int      bdd_setcacheratio(int);
+extern int      bdd_setopcachesize(int, int);
+extern int      bdd_opcachestats(int, bddOpCacheStat *);
 extern BDD      bdd_buildcube(int, int, BDD *);
 extern BDD      bdd_ibuildcube(int, int, int *);
 extern BDD      bdd_not(BDD);
@@ -421,6 +460,7 @@ extern const BDD bddtrue;
 /*=== User BDD class ===================================================*/
 
 class bvec;
+class zdd;
 
 class bdd
 {
@@ -533,6 +573,12 @@ private:
 
    friend int    bdd_addvarblock(const bdd &, int);
 
+   friend zdd    zdd_exist(const zdd &, const bdd &);
+   friend zdd    zdd_relprod(const zdd &, const zdd &, const bdd &);
+   friend zdd    zdd_restrict(const zdd &, const bdd &);
+   friend zdd    zdd_frombdd(const bdd &);
+   friend bdd    zdd_tobdd(const zdd &);
+
    friend class bvec;
    friend bvec bvec_ite(const bdd& a, const bvec& b, const bvec& c);
    friend bvec bvec_shlfixed(const bvec &e, int pos, const bdd &c);
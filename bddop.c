@@ -106,6 +106,7 @@ static BddCache itecache;           /* Cache for ITE results */
 static BddCache quantcache;         /* Cache for exist/forall results */
 static BddCache appexcache;         /* Cache for appex/appall results */
 static BddCache replacecache;       /* Cache for replace results */
+static BddCache restrictcache;      /* Cache for restrict results */
 static BddCache misccache;          /* Cache for other results */
 static int cacheratio;
 static BDD satPolarity;
@@ -188,6 +189,9 @@ int bdd_operator_init(int cachesize)
    if (BddCache_init(&replacecache,cachesize) < 0)
       return bdd_error(BDD_MEMORY);
 
+   if (BddCache_init(&restrictcache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
    if (BddCache_init(&misccache,cachesize) < 0)
       return bdd_error(BDD_MEMORY);
 
@@ -210,6 +214,7 @@ void bdd_operator_done(void)
    BddCache_done(&quantcache);
    BddCache_done(&appexcache);
    BddCache_done(&replacecache);
+   BddCache_done(&restrictcache);
    BddCache_done(&misccache);
 
    if (supportSet != NULL)
@@ -224,7 +229,9 @@ void bdd_operator_reset(void)
    BddCache_reset(&quantcache);
    BddCache_reset(&appexcache);
    BddCache_reset(&replacecache);
+   BddCache_reset(&restrictcache);
    BddCache_reset(&misccache);
+   bdd_zdd_reset();
 }
 
 
@@ -241,18 +248,35 @@ void bdd_operator_varresize(void)
 }
 
 
+static BddCache *bdd_operator_cache(int id)
+{
+   switch (id)
+   {
+   case BDD_CACHE_APPLY:    return &applycache;
+   case BDD_CACHE_ITE:      return &itecache;
+   case BDD_CACHE_QUANT:    return &quantcache;
+   case BDD_CACHE_APPEX:    return &appexcache;
+   case BDD_CACHE_REPLACE:  return &replacecache;
+   case BDD_CACHE_RESTRICT: return &restrictcache;
+   case BDD_CACHE_MISC:     return &misccache;
+   }
+   return NULL;
+}
+
+
 static void bdd_operator_noderesize(void)
 {
    if (cacheratio > 0)
    {
       int newcachesize = bddnodesize / cacheratio;
-      
-      BddCache_resize(&applycache, newcachesize);
-      BddCache_resize(&itecache, newcachesize);
-      BddCache_resize(&quantcache, newcachesize);
-      BddCache_resize(&appexcache, newcachesize);
-      BddCache_resize(&replacecache, newcachesize);
-      BddCache_resize(&misccache, newcachesize);
+      int n;
+
+      for (n=0 ; n<BDD_CACHE_NUM ; n++)
+      {
+	 BddCache *cache = bdd_operator_cache(n);
+	 if (!cache->fixedsize)
+	    BddCache_resize(cache, newcachesize);
+      }
    }
 }
 
@@ -292,6 +316,79 @@ int bdd_setcacheratio(int r)
 }
 
 
+/*
+NAME    {* bdd\_setopcachesize *}
+SECTION {* kernel *}
+SHORT   {* Sets the size of a single operator cache *}
+PROTO   {* int bdd_setopcachesize(int cache, int size) *}
+DESCR   {* Resizes one of the operator caches to {\tt size} entries,
+           independently of the others. {\tt cache} is one of
+	   {\tt BDD\_CACHE\_APPLY}, {\tt BDD\_CACHE\_ITE},
+	   {\tt BDD\_CACHE\_QUANT}, {\tt BDD\_CACHE\_APPEX} (also used by
+	   {\tt bdd\_relprod}), {\tt BDD\_CACHE\_REPLACE},
+	   {\tt BDD\_CACHE\_RESTRICT} and {\tt BDD\_CACHE\_MISC}. A cache
+	   sized this way keeps its size when the node table grows, even if
+	   a cache ratio is set. Passing a size of 0 hands the cache back to
+	   the cache ratio. The package must be running. *}
+RETURN  {* The previous size of the cache or a negative number on error. *}
+ALSO    {* bdd\_setcacheratio, bdd\_opcachestats *}
+*/
+int bdd_setopcachesize(int id, int size)
+{
+   BddCache *cache = bdd_operator_cache(id);
+   int old, err;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+   if (cache == NULL  ||  size < 0)
+      return bdd_error(BDD_RANGE);
+
+   old = cache->tablesize;
+   cache->fixedsize = size > 0;
+      /* BddCache_resize reports failure through bdd_error itself */
+   if (size > 0)
+      return (err=BddCache_resize(cache, size)) < 0 ? err : old;
+
+   if (cacheratio > 0)
+      BddCache_resize(cache, bddnodesize / cacheratio);
+   return old;
+}
+
+
+/*
+NAME    {* bdd\_opcachestats *}
+SECTION {* kernel *}
+SHORT   {* Fetch statistics about one operator cache *}
+PROTO   {* int bdd_opcachestats(int cache, bddOpCacheStat *stat) *}
+DESCR   {* Stores the size and the hit, miss and eviction counts of the
+           operator cache {\tt cache} in {\tt stat}. The counters are
+	   kept from {\tt bdd\_init} on and are not cleared by garbage
+	   collections. See {\tt bdd\_setopcachesize} for the cache
+	   identifiers.
+	   \begin{tabular}{lp{10cm}}
+	   {\tt size}      & Number of entries in the cache \\
+	   {\tt hits}      & Lookups that found a stored result \\
+	   {\tt misses}    & Lookups that had to compute the result \\
+	   {\tt evictions} & Stores that overwrote another valid result
+	   \end{tabular} *}
+RETURN  {* Zero on success, otherwise a negative error code. *}
+ALSO    {* bdd\_setopcachesize, bdd\_cachestats *}
+*/
+int bdd_opcachestats(int id, bddOpCacheStat *s)
+{
+   BddCache *cache = bdd_operator_cache(id);
+
+   if (cache == NULL  ||  s == NULL)
+      return bdd_error(BDD_RANGE);
+
+   s->size = cache->tablesize;
+   s->hits = cache->hits;
+   s->misses = cache->misses;
+   s->evictions = cache->evicts;
+   return 0;
+}
+
+
 /*************************************************************************
   Operators
 *************************************************************************/
@@ -436,11 +533,13 @@ static BDD not_rec(BDD r)
       
    if (entry->a == r  &&  entry->c == bddop_not)
    {
+      BddCache_hit(&applycache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&applycache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -450,6 +549,7 @@ static BDD not_rec(BDD r)
    res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
    POPREF(2);
    
+   BddCache_store(&applycache, entry);
    entry->a = r;
    entry->c = bddop_not;
    entry->r.res = res;
@@ -597,11 +697,13 @@ static BDD apply_rec(BDD l, BDD r)
       
       if (entry->a == l  &&  entry->b == r  &&  entry->c == applyop)
       {
+	 BddCache_hit(&applycache);
 #ifdef CACHESTATS
 	 bddcachestats.opHit++;
 #endif
 	 return entry->r.res;
       }
+      BddCache_miss(&applycache);
 #ifdef CACHESTATS
       bddcachestats.opMiss++;
 #endif
@@ -628,6 +730,7 @@ static BDD apply_rec(BDD l, BDD r)
 
       POPREF(2);
 
+      BddCache_store(&applycache, entry);
       entry->a = l;
       entry->b = r;
       entry->c = applyop;
@@ -781,11 +884,13 @@ static BDD ite_rec(BDD f, BDD g, BDD h)
    entry = BddCache_lookup(&itecache, ITEHASH(f,g,h));
    if (entry->a == f  &&  entry->b == g  &&  entry->c == h)
    {
+      BddCache_hit(&itecache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&itecache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -860,6 +965,7 @@ static BDD ite_rec(BDD f, BDD g, BDD h)
 
    POPREF(2);
 
+   BddCache_store(&itecache, entry);
    entry->a = f;
    entry->b = g;
    entry->c = h;
@@ -945,14 +1051,16 @@ static int restrict_rec(int r)
    if (ISCONST(r)  ||  LEVEL(r) > quantlast)
       return r;
 
-   entry = BddCache_lookup(&misccache, RESTRHASH(r,miscid));
+   entry = BddCache_lookup(&restrictcache, RESTRHASH(r,miscid));
    if (entry->a == r  &&  entry->c == miscid)
    {
+      BddCache_hit(&restrictcache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&restrictcache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -972,6 +1080,7 @@ static int restrict_rec(int r)
       POPREF(2);
    }
 
+   BddCache_store(&restrictcache, entry);
    entry->a = r;
    entry->c = miscid;
    entry->r.res = res;
@@ -1043,11 +1152,13 @@ static BDD constrain_rec(BDD f, BDD c)
    entry = BddCache_lookup(&misccache, CONSTRAINHASH(f,c));
    if (entry->a == f  &&  entry->b == c  &&  entry->c == miscid)
    {
+      BddCache_hit(&misccache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&misccache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -1089,6 +1200,7 @@ static BDD constrain_rec(BDD f, BDD c)
       }
    }
 
+   BddCache_store(&misccache, entry);
    entry->a = f;
    entry->b = c;
    entry->c = miscid;
@@ -1159,11 +1271,13 @@ static BDD replace_rec(BDD r)
    entry = BddCache_lookup(&replacecache, REPLACEHASH(r));
    if (entry->a == r  &&  entry->c == replaceid)
    {
+      BddCache_hit(&replacecache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&replacecache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -1174,6 +1288,7 @@ static BDD replace_rec(BDD r)
    res = bdd_correctify(LEVEL(replacepair[LEVEL(r)]), READREF(2), READREF(1));
    POPREF(2);
 
+   BddCache_store(&replacecache, entry);
    entry->a = r;
    entry->c = replaceid;
    entry->r.res = res;
@@ -1283,11 +1398,13 @@ static BDD compose_rec(BDD f, BDD g)
    entry = BddCache_lookup(&replacecache, COMPOSEHASH(f,g));
    if (entry->a == f  &&  entry->b == g  &&  entry->c == replaceid)
    {
+      BddCache_hit(&replacecache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&replacecache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -1321,6 +1438,7 @@ static BDD compose_rec(BDD f, BDD g)
       res = ite_rec(g, HIGH(f), LOW(f));
    }
 
+   BddCache_store(&replacecache, entry);
    entry->a = f;
    entry->b = g;
    entry->c = replaceid;
@@ -1396,11 +1514,13 @@ static BDD veccompose_rec(BDD f)
    entry = BddCache_lookup(&replacecache, VECCOMPOSEHASH(f));
    if (entry->a == f  &&  entry->c == replaceid)
    {
+      BddCache_hit(&replacecache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&replacecache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -1410,6 +1530,7 @@ static BDD veccompose_rec(BDD f)
    res = ite_rec(replacepair[LEVEL(f)], READREF(1), READREF(2));
    POPREF(2);
 
+   BddCache_store(&replacecache, entry);
    entry->a = f;
    entry->c = replaceid;
    entry->r.res = res;
@@ -1482,11 +1603,13 @@ static BDD simplify_rec(BDD f, BDD d)
    
    if (entry->a == f  &&  entry->b == d  &&  entry->c == bddop_simplify)
    {
+      BddCache_hit(&applycache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&applycache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -1521,6 +1644,7 @@ static BDD simplify_rec(BDD f, BDD d)
       POPREF(1);
    }
 
+   BddCache_store(&applycache, entry);
    entry->a = f;
    entry->b = d;
    entry->c = bddop_simplify;
@@ -1699,11 +1823,13 @@ static int quant_rec(int r)
    entry = BddCache_lookup(&quantcache, QUANTHASH(r));
    if (entry->a == r  &&  entry->c == quantid)
    {
+      BddCache_hit(&quantcache);
 #ifdef CACHESTATS
       bddcachestats.opHit++;
 #endif
       return entry->r.res;
    }
+   BddCache_miss(&quantcache);
 #ifdef CACHESTATS
    bddcachestats.opMiss++;
 #endif
@@ -1718,6 +1844,7 @@ static int quant_rec(int r)
 
    POPREF(2);
    
+   BddCache_store(&quantcache, entry);
    entry->a = r;
    entry->c = quantid;
    entry->r.res = res;
@@ -1988,11 +2115,13 @@ static int appquant_rec(int l, int r)
       entry = BddCache_lookup(&appexcache, APPEXHASH(l,r,appexop));
       if (entry->a == l  &&  entry->b == r  &&  entry->c == appexid)
       {
+	 BddCache_hit(&appexcache);
 #ifdef CACHESTATS
 	 bddcachestats.opHit++;
 #endif
 	 return entry->r.res;
       }
+      BddCache_miss(&appexcache);
 #ifdef CACHESTATS
       bddcachestats.opMiss++;
 #endif
@@ -2028,6 +2157,7 @@ static int appquant_rec(int l, int r)
 
       POPREF(2);
       
+      BddCache_store(&appexcache, entry);
       entry->a = l;
       entry->b = r;
       entry->c = appexid;
@@ -2502,7 +2632,11 @@ static double satcount_rec(int root)
 
    entry = BddCache_lookup(&misccache, SATCOUHASH(root));
    if (entry->a == root  &&  entry->c == miscid)
+   {
+      BddCache_hit(&misccache);
       return entry->r.dres;
+   }
+   BddCache_miss(&misccache);
 
    node = &bddnodes[root];
    size = 0;
@@ -2515,6 +2649,7 @@ static double satcount_rec(int root)
    s *= pow(2.0, (float)(LEVEL(HIGHp(node)) - LEVELp(node) - 1));
    size += s * satcount_rec(HIGHp(node));
 
+   BddCache_store(&misccache, entry);
    entry->a = root;
    entry->c = miscid;
    entry->r.dres = size;
@@ -2588,7 +2723,11 @@ static double satcountln_rec(int root)
 
    entry = BddCache_lookup(&misccache, SATCOUHASH(root));
    if (entry->a == root  &&  entry->c == miscid)
+   {
+      BddCache_hit(&misccache);
       return entry->r.dres;
+   }
+   BddCache_miss(&misccache);
 
    node = &bddnodes[root];
 
@@ -2609,6 +2748,7 @@ static double satcountln_rec(int root)
    else
       size = s1 + log1p(pow(2.0,s2-s1)) / M_LN2;
    
+   BddCache_store(&misccache, entry);
    entry->a = root;
    entry->c = miscid;
    entry->r.dres = size;
@@ -2754,10 +2894,15 @@ static double bdd_pathcount_rec(BDD r)
 
    entry = BddCache_lookup(&misccache, PATHCOUHASH(r));
    if (entry->a == r  &&  entry->c == miscid)
+   {
+      BddCache_hit(&misccache);
       return entry->r.dres;
+   }
+   BddCache_miss(&misccache);
 
    size = bdd_pathcount_rec(LOW(r)) + bdd_pathcount_rec(HIGH(r));
 
+   BddCache_store(&misccache, entry);
    entry->a = r;
    entry->c = miscid;
    entry->r.dres = size;
@@ -54,6 +54,10 @@ int BddCache_init(BddCache *cache, int size)
    for (n=0 ; n<size ; n++)
       cache->table[n].a = -1;
    cache->tablesize = size;
+   cache->fixedsize = 0;
+   cache->hits = 0;
+   cache->misses = 0;
+   cache->evicts = 0;
    
    return 0;
 }
@@ -53,6 +53,10 @@ typedef struct
 {
    BddCacheData *table;
    int tablesize;
+   int fixedsize;          /* Size set by the user, ignores the cache ratio */
+   unsigned long hits;     /* Lookups that found their result */
+   unsigned long misses;   /* Lookups that had to compute the result */
+   unsigned long evicts;   /* Stores that replaced another valid result */
 } BddCache;
 
 
@@ -63,6 +67,12 @@ extern void BddCache_reset(BddCache *);
 
 #define BddCache_lookup(cache, hash) (&(cache)->table[hash % (cache)->tablesize])
 
+   /* Counters for bdd_cachestats; call store before overwriting 'entry' */
+#define BddCache_hit(cache)  ((cache)->hits++)
+#define BddCache_miss(cache) ((cache)->misses++)
+#define BddCache_store(cache, entry) \
+   do { if ((entry)->a != -1) (cache)->evicts++; } while (0)
+
 
 #endif /* _CACHE_H */
 
@@ -44,6 +44,19 @@
 #include <time.h>
 #include <assert.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#if defined(MAP_ANONYMOUS) || defined(MAP_ANON)
+#define NODETABLE_MMAP
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+#endif
+#endif
+
 #include "kernel.h"
 #include "cache.h"
 #include "prime.h"
@@ -114,6 +127,9 @@ static int      usednodes_nextreorder; /* When to do reorder next time */
 static bddinthandler  err_handler;     /* Error handler */
 static bddgbchandler  gbc_handler;     /* Garbage collection handler */
 static bdd2inthandler resize_handler;  /* Node-table-resize handler */
+static int      nodereserve;           /* Nodes to reserve with mmap */
+static int      nodemapped;            /* Nodes mapped for the table, 0 if
+					  it is allocated with malloc */
 
 
    /* Strings for all error mesages */
@@ -145,6 +161,60 @@ static char *errorstrings[BDD_ERRNUM] =
   BDD misc. user operations
 *************************************************************************/
 
+   /* Allocate the initial node table, reserving the whole mmap range
+      if requested */
+static BddNode *bdd_nodetable_alloc(int size)
+{
+#ifdef NODETABLE_MMAP
+   if (nodereserve > 0)
+   {
+      int mapsize = MAX(nodereserve, size);
+      void *table = mmap(NULL, sizeof(BddNode)*(size_t)mapsize,
+			 PROT_READ|PROT_WRITE,
+			 MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+
+      if (table != MAP_FAILED)
+      {
+#ifdef MADV_HUGEPAGE
+	 madvise(table, sizeof(BddNode)*(size_t)mapsize, MADV_HUGEPAGE);
+#endif
+	 nodemapped = mapsize;
+	 return (BddNode*)table;
+      }
+   }
+#endif
+
+   nodemapped = 0;
+   return (BddNode*)malloc(sizeof(BddNode)*size);
+}
+
+
+   /* Grow the node table to 'size' nodes. A mapped table only has to
+      touch the new pages, the old nodes stay where they are */
+static BddNode *bdd_nodetable_grow(int size)
+{
+   if (nodemapped > 0)
+      return size <= nodemapped ? bddnodes : NULL;
+
+   return (BddNode*)realloc(bddnodes, sizeof(BddNode)*size);
+}
+
+
+static void bdd_nodetable_free(void)
+{
+#ifdef NODETABLE_MMAP
+   if (nodemapped > 0)
+   {
+      munmap(bddnodes, sizeof(BddNode)*(size_t)nodemapped);
+      nodemapped = 0;
+      return;
+   }
+#endif
+
+   free(bddnodes);
+}
+
+
 /*
 NAME   {* bdd\_init *}
 SECTION {* kernel *}
@@ -179,7 +249,7 @@ int bdd_init(int initnodesize, int cs)
    
    bddnodesize = bdd_prime_gte(initnodesize);
    
-   if ((bddnodes=(BddNode*)malloc(sizeof(BddNode)*bddnodesize)) == NULL)
+   if ((bddnodes=bdd_nodetable_alloc(bddnodesize)) == NULL)
       return bdd_error(BDD_MEMORY);
 
    bddresized = 0;
@@ -204,6 +274,12 @@ int bdd_init(int initnodesize, int cs)
       return err;
    }
 
+   if ((err=bdd_zdd_init(cs)) < 0)
+   {
+      bdd_done();
+      return err;
+   }
+
    bddfreepos = 2;
    bddfreenum = bddnodesize-2;
    bddrunning = 1;
@@ -254,7 +330,8 @@ void bdd_done(void)
    bdd_reorder_done();
    bdd_pairs_done();
    
-   free(bddnodes);
+   if (bddnodes != NULL)
+      bdd_nodetable_free();
    free(bddrefstack);
    free(bddvarset);
    free(bddvar2level);
@@ -265,6 +342,7 @@ void bdd_done(void)
    bddvarset = NULL;
 
    bdd_operator_done();
+   bdd_zdd_done();
 
    bddrunning = 0;
    bddnodesize = 0;
@@ -578,6 +656,40 @@ int bdd_setmaxnodenum(int size)
 }
 
 
+/*
+NAME    {* bdd\_setnodereserve *}
+SECTION {* kernel *}
+SHORT   {* reserve address space for the node table *}
+PROTO   {* int bdd_setnodereserve(int size) *}
+DESCR   {* When {\tt size} is positive, the next call to {\tt bdd\_init}
+           reserves virtual address space for {\tt size} nodes with
+	   {\tt mmap} instead of allocating the node table with
+	   {\tt malloc}. The table then grows in place up to that size, so a
+	   resize never copies the existing nodes, and the range is advised
+	   for transparent huge pages where the system supports it. Pages are
+	   only committed when the table grows into them. The reservation
+	   also acts as a maximum node count. A value of 0, the default,
+	   selects the usual {\tt malloc}/{\tt realloc} table. The setting
+	   must be made before {\tt bdd\_init} and is kept across
+	   {\tt bdd\_done}. If the range cannot be mapped the package falls
+	   back to {\tt malloc}. *}
+RETURN  {* The previous reservation, or a negative error code. *}
+ALSO    {* bdd\_init, bdd\_setmaxnodenum *}
+*/
+int bdd_setnodereserve(int size)
+{
+   int old = nodereserve;
+
+   if (bddrunning)
+      return bdd_error(BDD_RUNNING);
+   if (size < 0)
+      return bdd_error(BDD_SIZE);
+
+   nodereserve = size;
+   return old;
+}
+
+
 /*
 NAME    {* bdd\_setminfreenodes *}
 SECTION {* kernel *}
@@ -1255,12 +1367,11 @@ void bdd_unmark_upto(int i, int level)
   Unique node table functions
 *************************************************************************/
 
+static int bdd_uniquenode(unsigned int, int, int);
+
+
 int bdd_makenode(unsigned int level, int low, int high)
 {
-   register BddNode *node;
-   register unsigned int hash;
-   register int res;
-
 #ifdef CACHESTATS
    bddcachestats.uniqueAccess++;
 #endif
@@ -1269,6 +1380,32 @@ int bdd_makenode(unsigned int level, int low, int high)
    if (low == high)
       return low;
 
+   return bdd_uniquenode(level, low, high);
+}
+
+
+   /* Same as bdd_makenode but with the zero-suppressed reduction rule:
+      a node whose high branch is the empty family is removed, while
+      nodes with equal branches are kept. */
+int zdd_makenode(unsigned int level, int low, int high)
+{
+#ifdef CACHESTATS
+   bddcachestats.uniqueAccess++;
+#endif
+   
+   if (high == 0)
+      return low;
+
+   return bdd_uniquenode(level, low, high);
+}
+
+
+static int bdd_uniquenode(unsigned int level, int low, int high)
+{
+   register BddNode *node;
+   register unsigned int hash;
+   register int res;
+
       /* Try to find an existing node of this kind */
    hash = NODEHASH(level, low, high);
    res = bddnodes[hash].hash;
@@ -1351,6 +1488,8 @@ int bdd_noderesize(int doRehash)
 
    if (bddnodesize >= bddmaxnodesize  &&  bddmaxnodesize > 0)
       return -1;
+   if (nodemapped > 0  &&  bdd_prime_lte(nodemapped) <= (unsigned int)bddnodesize)
+      return -1;
    
    bddnodesize = bddnodesize << 1;
 
@@ -1360,14 +1499,22 @@ int bdd_noderesize(int doRehash)
    if (bddnodesize > bddmaxnodesize  &&  bddmaxnodesize > 0)
       bddnodesize = bddmaxnodesize;
 
+   if (bddnodesize > nodemapped  &&  nodemapped > 0)
+      bddnodesize = nodemapped;
+
    bddnodesize = bdd_prime_lte(bddnodesize);
    
    if (resize_handler != NULL)
       resize_handler(oldsize, bddnodesize);
 
-   newnodes = (BddNode*)realloc(bddnodes, sizeof(BddNode)*bddnodesize);
+      /* The hash chains depend on the table size, so a table that grows
+	 in place still has to be rehashed below */
+   newnodes = bdd_nodetable_grow(bddnodesize);
    if (newnodes == NULL)
+   {
+      bddnodesize = oldsize;
       return bdd_error(BDD_MEMORY);
+   }
    bddnodes = newnodes;
 
    if (doRehash)
@@ -185,6 +185,7 @@ extern "C" {
    
 extern int    bdd_error(int);
 extern int    bdd_makenode(unsigned int, int, int);
+extern int    zdd_makenode(unsigned int, int, int);
 extern int    bdd_noderesize(int);
 extern void   bdd_checkreorder(void);
 extern void   bdd_mark(int);
@@ -208,6 +209,10 @@ extern void   bdd_pairs_vardown(int);
 extern void   bdd_fdd_init(void);
 extern void   bdd_fdd_done(void);
 
+extern int    bdd_zdd_init(int);
+extern void   bdd_zdd_done(void);
+extern void   bdd_zdd_reset(void);
+
 extern void   bdd_reorder_init(void);
 extern void   bdd_reorder_done(void);
 extern int    bdd_reorder_ready(void);
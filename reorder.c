@@ -67,7 +67,7 @@ static int bddreordermethod;
 static int bddreordertimes;
 
    /* Flag for disabling reordering temporarily */
-static int reorderdisabled;
+int bddreorderdisabled;
 
    /* Store for the variable relationships */
 static BddTree *vartree;
@@ -139,7 +139,7 @@ typedef struct s_sizePair
 
 void bdd_reorder_init(void)
 {
-   reorderdisabled = 0;
+   bddreorderdisabled = 0;
    vartree = NULL;
    
    bdd_clrvarblocks();
@@ -1597,7 +1597,7 @@ ALSO    {* bdd\_enable\_reorder *}
 */
 void bdd_disable_reorder(void)
 {
-   reorderdisabled = 1;
+   bddreorderdisabled = 1;
 }
 
 
@@ -1611,14 +1611,14 @@ ALSO    {* bdd\_disable\_reorder *}
 */
 void bdd_enable_reorder(void)
 {
-   reorderdisabled = 0;
+   bddreorderdisabled = 0;
 }
 
 
 int bdd_reorder_ready(void)
 {
    if (bddreordermethod == BDD_REORDER_NONE  ||  vartree == NULL  ||
-       bddreordertimes == 0  ||  reorderdisabled)
+       bddreordertimes == 0  ||  bddreorderdisabled)
       return 0;
    return 1;
 }
@@ -0,0 +1,37 @@
+; Goal of this test
+; every call to a heap allocator gets its own location, so memory from
+; two different malloc calls does not alias. strdup is in the summary
+; table, nothrow operator new is not: TLI still knows it as an allocator
+; (isAllocationFn), so the call gets its own location as well
+
+%"struct.std::nothrow_t" = type { i8 }
+
+@A = global i32 1
+@S = global [4 x i8] c"abc\00"
+@_ZSt7nothrow = external global %"struct.std::nothrow_t"
+
+declare i8* @malloc(i64)
+declare i8* @strdup(i8*)
+declare i8* @_ZnwmRKSt9nothrow_t(i64, %"struct.std::nothrow_t"*)
+
+define i32 @main() {
+	%P = call i8* @malloc(i64 8)
+	%Q = call i8* @malloc(i64 8)
+	%PP = bitcast i8* %P to i32**
+	%QP = bitcast i8* %Q to i32**
+	store i32* @A, i32** %PP
+	%X = load i32** %PP
+	%Y = load i32** %QP	; Q__HEAP is uninitialized, no A__VALUE from P
+	%D = call i8* @strdup(i8* getelementptr ([4 x i8]* @S, i32 0, i32 0))
+	%N = call i8* @_ZnwmRKSt9nothrow_t(i64 8, %"struct.std::nothrow_t"* @_ZSt7nothrow)
+	ret i32 0
+}
+
+;Expected Output
+; main_P -> main_P__HEAP
+; main_Q -> main_Q__HEAP
+; main_P__HEAP -> A__VALUE
+; main_X -> A__VALUE
+; main_Y -> EVERYTHING	(nothing was stored to main_Q__HEAP)
+; main_D -> main_D__HEAP
+; main_N -> main_N__HEAP
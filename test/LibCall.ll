@@ -0,0 +1,41 @@
+; Goal of this test
+; test calls to library declarations
+; memcpy copies what its source memory holds into its destination memory
+; and returns its destination, strchr returns a pointer into its argument,
+; printf has no effect on pointers, and a declaration without a summary
+; is treated like an undefined call
+
+@A = global i32 1
+@B = global i32 2
+@F = global [3 x i8] c"%d\00"
+
+declare i8* @memcpy(i8*, i8*, i64)
+declare i8* @strchr(i8*, i32)
+declare i32 @printf(i8*, ...)
+declare i8* @unknown(i8*)
+
+define i32 @main() {
+	%X = alloca i32*
+	%Y = alloca i32*
+	%Z = alloca i32*
+	store i32* @A, i32** %X
+	store i32* @B, i32** %Z
+	%XC = bitcast i32** %X to i8*
+	%YC = bitcast i32** %Y to i8*
+	%R = call i8* @memcpy(i8* %YC, i8* %XC, i64 8)
+	%Y1 = load i32** %Y
+	%C = call i8* @strchr(i8* %XC, i32 0)
+	%P = call i32 (i8*, ...)* @printf(i8* getelementptr ([3 x i8]* @F, i32 0, i32 0), i32 7)
+	%Z1 = load i32** %Z
+	%U = call i8* @unknown(i8* %XC)
+	%Z2 = load i32** %Z
+	ret i32 0
+}
+
+;Expected Output
+; main_R -> main_Y__HEAP
+; main_Y1 -> A__VALUE
+; main_C -> main_X__HEAP
+; main_Z1 -> B__VALUE
+; main_U -> EVERYTHING
+; main_Z2 -> EVERYTHING
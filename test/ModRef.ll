@@ -0,0 +1,50 @@
+; Goal of this test
+; mod/ref sets of functions, run with -debug-only=fsaa-modref
+; an indirect call may reach a declaration through its pointer. Declarations
+; have no points-to row of their own, so %F only names @def, and the call
+; must still count @ext, which may touch anything
+
+@G = global i32 0
+
+declare void @ext(i32*)
+
+define void @def(i32* %P) {
+	ret void
+}
+
+define void @reader(i32* %P) {
+	%X = load i32* %P
+	ret void
+}
+
+define void @direct() {
+	call void @def(i32* @G)
+	ret void
+}
+
+define void @caller(i1 %C) {
+entry:
+	br i1 %C, label %l1, label %l2
+l1:
+	br label %l3
+l2:
+	br label %l3
+l3:
+	%F = phi void (i32*)* [ @ext, %l1 ], [ @def, %l2 ]
+	call void %F(i32* @G)
+	ret void
+}
+
+define i32 @main() {
+	call void @direct()
+	call void @reader(i32* @G)
+	call void @caller(i1 true)
+	ret i32 0
+}
+
+;Expected Output
+; ACCESSES: def
+; ACCESSES: reader READS
+; ACCESSES: direct
+; ACCESSES: caller READS WRITES
+; ACCESSES: main READS WRITES
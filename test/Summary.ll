@@ -0,0 +1,35 @@
+; Goal of this test
+; run with -fsaa-summaries: calls apply the summary of @set and @id instead
+; of entering their SEGs, so the two calls to each keep their arguments
+; apart; without summaries both slots would hold A and B
+
+@A = global i32 1
+@B = global i32 2
+
+define void @set(i32** %P, i32* %V) {
+	store i32* %V, i32** %P
+	ret void
+}
+
+define i32* @id(i32* %X) {
+	ret i32* %X
+}
+
+define i32 @main() {
+	%S1 = alloca i32*
+	%S2 = alloca i32*
+	call void @set(i32** %S1, i32* @A)
+	call void @set(i32** %S2, i32* @B)
+	%L1 = load i32** %S1
+	%L2 = load i32** %S2
+	%R1 = call i32* @id(i32* @A)
+	%R2 = call i32* @id(i32* @B)
+	ret i32 0
+}
+
+;Expected Output
+; main_L1 -> A__VALUE
+; main_L2 -> B__VALUE
+; main_R1 -> A__VALUE
+; main_R2 -> B__VALUE
+; set_P -> main_S1__HEAP main_S2__HEAP	(every call's arguments, for queries)
@@ -0,0 +1,841 @@
+/*========================================================================
+               Copyright (C) 1996-2002 by Jorn Lind-Nielsen
+                            All rights reserved
+
+    Permission is hereby granted, without written agreement and without
+    license or royalty fees, to use, reproduce, prepare derivative
+    works, distribute, and display this software and its documentation
+    for any purpose, provided that (1) the above copyright notice and
+    the following two paragraphs appear in all copies of the source code
+    and (2) redistributions, including without limitation binaries,
+    reproduce these notices in the supporting documentation. Substantial
+    modifications to this software may be copyrighted by their authors
+    and need not follow the licensing terms described here, provided
+    that the new terms are clearly indicated in all files where they apply.
+
+    IN NO EVENT SHALL JORN LIND-NIELSEN, OR DISTRIBUTORS OF THIS
+    SOFTWARE BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL,
+    INCIDENTAL, OR CONSEQUENTIAL DAMAGES ARISING OUT OF THE USE OF THIS
+    SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE AUTHORS OR ANY OF THE
+    ABOVE PARTIES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    JORN LIND-NIELSEN SPECIFICALLY DISCLAIM ANY WARRANTIES, INCLUDING,
+    BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS
+    ON AN "AS IS" BASIS, AND THE AUTHORS AND DISTRIBUTORS HAVE NO
+    OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR
+    MODIFICATIONS.
+========================================================================*/
+
+/*************************************************************************
+  FILE:  zdd.c
+  DESCR: Zero-suppressed decision diagrams on top of the BDD kernel
+
+  A ZDD shares the node table, the unique hash and the garbage collector
+  with the BDDs. Only the reduction rule differs: a node is removed when
+  its high branch is the empty family, and a variable missing on a path
+  is read as false. Each satisfying assignment of a BDD is stored as the
+  set of its true variables, so a relation over a few FDD domains keeps
+  only the paths that are actually present.
+
+  Dynamic variable reordering swaps levels assuming the BDD reduction
+  rule and would corrupt ZDD nodes, so every ZDD operation turns
+  reordering off while it runs and restores the previous setting when
+  it returns. Callers that keep ZDDs alive between operations must not
+  enable reordering themselves; fs-aa never does.
+*************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kernel.h"
+#include "cache.h"
+#include "zdd.h"
+
+   /* Hash value modifiers to distinguish between entries in zddcache */
+#define ZCACHEID_UNION      0x0
+#define ZCACHEID_INTERSECT  0x1
+#define ZCACHEID_DIFF       0x2
+#define ZCACHEID_EXIST      0x3
+#define ZCACHEID_RESTRICT   0x4
+#define ZCACHEID_FROMBDD    0x5
+#define ZCACHEID_TOBDD      0x6
+#define ZCACHEID_COUNT      0x7
+
+   /* Variables needed for the operators */
+static BddCache zddcache;           /* Cache for all ZDD results */
+static int *zddnextlevel;           /* Next level in the current var. set */
+static int *zddsign;                /* Polarity of each level for restrict */
+static int zddtablesize;            /* Allocated size of the two tables */
+static int zddsetid;                /* Current cache id for var. set ops */
+static int zdddepth;                /* Nesting of ZDD operations */
+static int zddreordersaved;         /* Reordering was off before the outermost */
+
+   /* Internal prototypes */
+static ZDD    union_rec(ZDD, ZDD);
+static ZDD    intersect_rec(ZDD, ZDD);
+static ZDD    diff_rec(ZDD, ZDD);
+static ZDD    exist_rec(ZDD, int);
+static ZDD    restrict_rec(ZDD, int);
+static ZDD    frombdd_rec(BDD, int);
+static BDD    tobdd_rec(ZDD, int);
+static double count_rec(ZDD);
+static int    varset2leveltable(BDD, int);
+
+   /* Hashvalues */
+#define SETOPHASH(l,r,op)    (TRIPLE(l,r,op))
+#define LEVELOPHASH(r,lvl)   (PAIR(r,lvl))
+#define COUNTHASH(r)         (r)
+
+
+/*************************************************************************
+  Setup and shutdown
+*************************************************************************/
+
+int bdd_zdd_init(int cachesize)
+{
+   if (BddCache_init(&zddcache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   zddnextlevel = NULL;
+   zddsign = NULL;
+   zddtablesize = 0;
+   zddsetid = 0;
+   zdddepth = 0;
+
+   return 0;
+}
+
+
+void bdd_zdd_done(void)
+{
+   BddCache_done(&zddcache);
+
+   free(zddnextlevel);
+   free(zddsign);
+   zddnextlevel = NULL;
+   zddsign = NULL;
+   zddtablesize = 0;
+}
+
+
+void bdd_zdd_reset(void)
+{
+   BddCache_reset(&zddcache);
+}
+
+
+/*************************************************************************
+  Reordering guard
+*************************************************************************/
+
+   /* ZDD operations nest (zdd_relprod, zdd_replace), only the outermost
+      one changes the reordering setting */
+static void zdd_enter(void)
+{
+   if (zdddepth++ == 0)
+   {
+      zddreordersaved = bddreorderdisabled;
+      bdd_disable_reorder();
+   }
+}
+
+
+static ZDD zdd_leave(ZDD res)
+{
+   if (--zdddepth == 0  &&  !zddreordersaved)
+      bdd_enable_reorder();
+   return res;
+}
+
+
+/*************************************************************************
+  Set operations
+*************************************************************************/
+
+/*
+NAME    {* zdd\_union *}
+EXTRA   {* zdd\_intersect, zdd\_diff *}
+SECTION {* zdd *}
+SHORT   {* set operations on two ZDDs *}
+PROTO   {* ZDD zdd_union(ZDD l, ZDD r)
+ZDD zdd_intersect(ZDD l, ZDD r)
+ZDD zdd_diff(ZDD l, ZDD r) *}
+DESCR   {* Computes the union, intersection or difference of the two
+           families {\tt l} and {\tt r}. When both are built with
+	   {\tt zdd\_frombdd} these correspond to disjunction, conjunction
+	   and {\tt bddop\_diff} on the original BDDs. *}
+RETURN  {* The resulting family. *}
+ALSO    {* zdd\_frombdd, bdd\_apply *}
+*/
+ZDD zdd_union(ZDD l, ZDD r)
+{
+   CHECKa(l, bddfalse);
+   CHECKa(r, bddfalse);
+
+   zdd_enter();
+   INITREF;
+   return zdd_leave(union_rec(l, r));
+}
+
+
+ZDD zdd_intersect(ZDD l, ZDD r)
+{
+   CHECKa(l, bddfalse);
+   CHECKa(r, bddfalse);
+
+   zdd_enter();
+   INITREF;
+   return zdd_leave(intersect_rec(l, r));
+}
+
+
+ZDD zdd_diff(ZDD l, ZDD r)
+{
+   CHECKa(l, bddfalse);
+   CHECKa(r, bddfalse);
+
+   zdd_enter();
+   INITREF;
+   return zdd_leave(diff_rec(l, r));
+}
+
+
+static ZDD union_rec(ZDD l, ZDD r)
+{
+   BddCacheData *entry;
+   ZDD res;
+
+   if (ISZERO(l))
+      return r;
+   if (ISZERO(r)  ||  l == r)
+      return l;
+
+   entry = BddCache_lookup(&zddcache, SETOPHASH(l,r,ZCACHEID_UNION));
+   if (entry->a == l  &&  entry->b == r  &&  entry->c == ZCACHEID_UNION)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( union_rec(LOW(l), LOW(r)) );
+      PUSHREF( union_rec(HIGH(l), HIGH(r)) );
+      res = zdd_makenode(LEVEL(l), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else
+   if (LEVEL(l) < LEVEL(r))
+   {
+      PUSHREF( union_rec(LOW(l), r) );
+      res = zdd_makenode(LEVEL(l), READREF(1), HIGH(l));
+      POPREF(1);
+   }
+   else
+   {
+      PUSHREF( union_rec(l, LOW(r)) );
+      res = zdd_makenode(LEVEL(r), READREF(1), HIGH(r));
+      POPREF(1);
+   }
+
+   entry->a = l;
+   entry->b = r;
+   entry->c = ZCACHEID_UNION;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+static ZDD intersect_rec(ZDD l, ZDD r)
+{
+   BddCacheData *entry;
+   ZDD res;
+
+   if (ISZERO(l)  ||  ISZERO(r))
+      return 0;
+   if (l == r)
+      return l;
+
+   entry = BddCache_lookup(&zddcache, SETOPHASH(l,r,ZCACHEID_INTERSECT));
+   if (entry->a == l  &&  entry->b == r  &&  entry->c == ZCACHEID_INTERSECT)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( intersect_rec(LOW(l), LOW(r)) );
+      PUSHREF( intersect_rec(HIGH(l), HIGH(r)) );
+      res = zdd_makenode(LEVEL(l), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else
+   if (LEVEL(l) < LEVEL(r))
+      res = intersect_rec(LOW(l), r);
+   else
+      res = intersect_rec(l, LOW(r));
+
+   entry->a = l;
+   entry->b = r;
+   entry->c = ZCACHEID_INTERSECT;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+static ZDD diff_rec(ZDD l, ZDD r)
+{
+   BddCacheData *entry;
+   ZDD res;
+
+   if (ISZERO(l)  ||  l == r)
+      return 0;
+   if (ISZERO(r))
+      return l;
+
+   entry = BddCache_lookup(&zddcache, SETOPHASH(l,r,ZCACHEID_DIFF));
+   if (entry->a == l  &&  entry->b == r  &&  entry->c == ZCACHEID_DIFF)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( diff_rec(LOW(l), LOW(r)) );
+      PUSHREF( diff_rec(HIGH(l), HIGH(r)) );
+      res = zdd_makenode(LEVEL(l), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else
+   if (LEVEL(l) < LEVEL(r))
+   {
+      PUSHREF( diff_rec(LOW(l), r) );
+      res = zdd_makenode(LEVEL(l), READREF(1), HIGH(l));
+      POPREF(1);
+   }
+   else
+      res = diff_rec(l, LOW(r));
+
+   entry->a = l;
+   entry->b = r;
+   entry->c = ZCACHEID_DIFF;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+/*************************************************************************
+  Quantification, restriction and renaming
+*************************************************************************/
+
+/*
+NAME    {* zdd\_exist *}
+SECTION {* zdd *}
+SHORT   {* existential quantification of variables *}
+PROTO   {* ZDD zdd_exist(ZDD r, BDD var) *}
+DESCR   {* Removes the variables in the BDD variable set {\tt var} from
+           {\tt r} by existential quantification. As in a BDD the
+	   quantified variables become don't cares, so each of them is
+	   left as a node with equal branches. *}
+RETURN  {* The quantified ZDD. *}
+ALSO    {* zdd\_relprod, bdd\_exist, bdd\_makeset *}
+*/
+ZDD zdd_exist(ZDD r, BDD var)
+{
+   CHECKa(r, bddfalse);
+   CHECKa(var, bddfalse);
+
+   if (var < 2)  /* Empty set */
+      return r;
+
+   zdd_enter();
+   if (varset2leveltable(var, 0) < 0)
+      return zdd_leave(bddfalse);
+
+   INITREF;
+   zddsetid = (var << 3) | ZCACHEID_EXIST;
+   return zdd_leave(exist_rec(r, 0));
+}
+
+
+/*
+NAME    {* zdd\_relprod *}
+SECTION {* zdd *}
+SHORT   {* relational product of two ZDDs *}
+PROTO   {* ZDD zdd_relprod(ZDD l, ZDD r, BDD var) *}
+DESCR   {* Intersects {\tt l} and {\tt r} and quantifies the variables in
+           the BDD variable set {\tt var} out of the result. This is the
+	   ZDD counterpart of {\tt bdd\_relprod}. *}
+RETURN  {* The relational product. *}
+ALSO    {* zdd\_exist, zdd\_intersect, bdd\_appex *}
+*/
+ZDD zdd_relprod(ZDD l, ZDD r, BDD var)
+{
+   ZDD tmp, res;
+
+   zdd_enter();
+   tmp = bdd_addref( zdd_intersect(l, r) );
+   res = zdd_exist(tmp, var);
+   bdd_delref(tmp);
+
+   return zdd_leave(res);
+}
+
+
+/*
+NAME    {* zdd\_restrict *}
+SECTION {* zdd *}
+SHORT   {* restrict a set of variables to constant values *}
+PROTO   {* ZDD zdd_restrict(ZDD r, BDD var) *}
+DESCR   {* Restricts the variables in the BDD cube {\tt var} to the
+           polarity they have in the cube, exactly like
+	   {\tt bdd\_restrict}. The restricted variables become don't
+	   cares in the result. *}
+RETURN  {* The restricted ZDD. *}
+ALSO    {* bdd\_restrict, zdd\_exist *}
+*/
+ZDD zdd_restrict(ZDD r, BDD var)
+{
+   CHECKa(r, bddfalse);
+   CHECKa(var, bddfalse);
+
+   if (var < 2)  /* Empty set */
+      return r;
+
+   zdd_enter();
+   if (varset2leveltable(var, 1) < 0)
+      return zdd_leave(bddfalse);
+
+   INITREF;
+   zddsetid = (var << 3) | ZCACHEID_RESTRICT;
+   return zdd_leave(restrict_rec(r, 0));
+}
+
+
+static ZDD exist_rec(ZDD r, int level)
+{
+   BddCacheData *entry;
+   ZDD res;
+   int q = zddnextlevel[level];
+
+   if (ISZERO(r)  ||  q >= bddvarnum)
+      return r;
+
+   entry = BddCache_lookup(&zddcache, LEVELOPHASH(r,q));
+   if (entry->a == r  &&  entry->b == q  &&  entry->c == zddsetid)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if ((int)LEVEL(r) < q)
+   {
+      PUSHREF( exist_rec(LOW(r), LEVEL(r)+1) );
+      PUSHREF( exist_rec(HIGH(r), LEVEL(r)+1) );
+      res = zdd_makenode(LEVEL(r), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else
+   if ((int)LEVEL(r) == q)
+   {
+      PUSHREF( exist_rec(LOW(r), q+1) );
+      PUSHREF( exist_rec(HIGH(r), q+1) );
+      res = union_rec(READREF(2), READREF(1));
+      POPREF(2);
+      PUSHREF( res );
+      res = zdd_makenode(q, res, res);
+      POPREF(1);
+   }
+   else
+   {
+	 /* Variable q is false everywhere in r */
+      PUSHREF( exist_rec(r, q+1) );
+      res = zdd_makenode(q, READREF(1), READREF(1));
+      POPREF(1);
+   }
+
+   entry->a = r;
+   entry->b = q;
+   entry->c = zddsetid;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+static ZDD restrict_rec(ZDD r, int level)
+{
+   BddCacheData *entry;
+   ZDD res, child;
+   int q = zddnextlevel[level];
+
+   if (ISZERO(r)  ||  q >= bddvarnum)
+      return r;
+
+   entry = BddCache_lookup(&zddcache, LEVELOPHASH(r,q));
+   if (entry->a == r  &&  entry->b == q  &&  entry->c == zddsetid)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if ((int)LEVEL(r) < q)
+   {
+      PUSHREF( restrict_rec(LOW(r), LEVEL(r)+1) );
+      PUSHREF( restrict_rec(HIGH(r), LEVEL(r)+1) );
+      res = zdd_makenode(LEVEL(r), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else
+   {
+      if ((int)LEVEL(r) == q)
+	 child = zddsign[q] > 0 ? HIGH(r) : LOW(r);
+      else
+	 child = zddsign[q] > 0 ? 0 : r;
+
+      PUSHREF( restrict_rec(child, q+1) );
+      res = zdd_makenode(q, READREF(1), READREF(1));
+      POPREF(1);
+   }
+
+   entry->a = r;
+   entry->b = q;
+   entry->c = zddsetid;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+/*
+NAME    {* zdd\_replace *}
+SECTION {* zdd *}
+SHORT   {* replace variables *}
+PROTO   {* ZDD zdd_replace(ZDD r, bddPair *pair) *}
+DESCR   {* Replaces all variables in {\tt r} with the variables defined by
+           {\tt pair}, as {\tt bdd\_replace} does. Only plain variable
+	   pairs are supported, and the new variables must be don't cares
+	   in {\tt r}, which is the case when moving a relation from one
+	   FDD domain to another after a restriction. The renaming is
+	   computed as a relational product with the equality relation
+	   between the old and the new variables. *}
+RETURN  {* The renamed ZDD. *}
+ALSO    {* bdd\_replace, bdd\_newpair, zdd\_relprod *}
+*/
+ZDD zdd_replace(ZDD r, bddPair *pair)
+{
+   BDD eq, neweq, vars, tmp;
+   ZDD zeq, res;
+   int n;
+
+   CHECKa(r, bddfalse);
+
+   zdd_enter();
+   eq = bdd_addref(bddtrue);
+   vars = bdd_addref(bddtrue);
+
+   for (n=0 ; n<=pair->last ; n++)
+   {
+      BDD to = pair->result[n];
+
+      if ((int)LEVEL(to) == n)
+	 continue;
+      if (ISCONST(to)  ||  LOW(to) != 0  ||  HIGH(to) != 1)
+      {
+	 bdd_delref(eq);
+	 bdd_delref(vars);
+	 bdd_error(BDD_ILLBDD);
+	 return zdd_leave(bddfalse);
+      }
+
+      tmp = bdd_addref( bdd_apply(bdd_ithvar(bddlevel2var[n]), to,
+				  bddop_biimp) );
+      /* eq must stay referenced until the conjunction is built, a
+	 garbage collection inside bdd_apply would reclaim it */
+      neweq = bdd_addref( bdd_apply(eq, tmp, bddop_and) );
+      bdd_delref(eq);
+      eq = neweq;
+      bdd_delref(tmp);
+
+      tmp = bdd_addref( bdd_apply(vars, bdd_ithvar(bddlevel2var[n]),
+				  bddop_and) );
+      bdd_delref(vars);
+      vars = tmp;
+   }
+
+   zeq = bdd_addref( zdd_frombdd(eq) );
+   res = zdd_relprod(r, zeq, vars);
+
+   bdd_delref(zeq);
+   bdd_delref(eq);
+   bdd_delref(vars);
+
+   return zdd_leave(res);
+}
+
+
+/*************************************************************************
+  Conversion and counting
+*************************************************************************/
+
+/*
+NAME    {* zdd\_frombdd *}
+EXTRA   {* zdd\_tobdd *}
+SECTION {* zdd *}
+SHORT   {* convert between BDDs and ZDDs *}
+PROTO   {* ZDD zdd_frombdd(BDD r)
+BDD zdd_tobdd(ZDD r) *}
+DESCR   {* {\tt zdd\_frombdd} builds the family of all satisfying
+           assignments of {\tt r} over every defined variable, and
+	   {\tt zdd\_tobdd} builds the characteristic function of such a
+	   family. The two are inverse to each other. *}
+RETURN  {* The converted diagram. *}
+ALSO    {* zdd\_count *}
+*/
+ZDD zdd_frombdd(BDD r)
+{
+   CHECKa(r, bddfalse);
+
+   zdd_enter();
+   INITREF;
+   return zdd_leave(frombdd_rec(r, 0));
+}
+
+
+BDD zdd_tobdd(ZDD r)
+{
+   CHECKa(r, bddfalse);
+
+   zdd_enter();
+   INITREF;
+   return zdd_leave(tobdd_rec(r, 0));
+}
+
+
+static ZDD frombdd_rec(BDD r, int level)
+{
+   BddCacheData *entry;
+   ZDD res;
+
+   if (ISZERO(r)  ||  level >= bddvarnum)
+      return r;
+
+   entry = BddCache_lookup(&zddcache, LEVELOPHASH(r,level));
+   if (entry->a == r  &&  entry->b == level  &&
+       entry->c == ZCACHEID_FROMBDD)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if ((int)LEVEL(r) > level)
+   {
+      PUSHREF( frombdd_rec(r, level+1) );
+      res = zdd_makenode(level, READREF(1), READREF(1));
+      POPREF(1);
+   }
+   else
+   {
+      PUSHREF( frombdd_rec(LOW(r), level+1) );
+      PUSHREF( frombdd_rec(HIGH(r), level+1) );
+      res = zdd_makenode(level, READREF(2), READREF(1));
+      POPREF(2);
+   }
+
+   entry->a = r;
+   entry->b = level;
+   entry->c = ZCACHEID_FROMBDD;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+static BDD tobdd_rec(ZDD r, int level)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if (ISZERO(r)  ||  level >= bddvarnum)
+      return r;
+
+   entry = BddCache_lookup(&zddcache, LEVELOPHASH(r,level));
+   if (entry->a == r  &&  entry->b == level  &&  entry->c == ZCACHEID_TOBDD)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.res;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   if ((int)LEVEL(r) > level)
+   {
+	 /* Variable is false on every path below this point */
+      PUSHREF( tobdd_rec(r, level+1) );
+      res = bdd_makenode(level, READREF(1), 0);
+      POPREF(1);
+   }
+   else
+   {
+      PUSHREF( tobdd_rec(LOW(r), level+1) );
+      PUSHREF( tobdd_rec(HIGH(r), level+1) );
+      res = bdd_makenode(level, READREF(2), READREF(1));
+      POPREF(2);
+   }
+
+   entry->a = r;
+   entry->b = level;
+   entry->c = ZCACHEID_TOBDD;
+   entry->r.res = res;
+
+   return res;
+}
+
+
+/*
+NAME    {* zdd\_count *}
+SECTION {* zdd *}
+SHORT   {* number of sets in a family *}
+PROTO   {* double zdd_count(ZDD r) *}
+DESCR   {* Counts the sets in the family {\tt r}. For a ZDD built by
+           {\tt zdd\_frombdd} this equals {\tt bdd\_satcount} of the
+	   original BDD. *}
+RETURN  {* The number of sets. *}
+ALSO    {* bdd\_satcount *}
+*/
+double zdd_count(ZDD r)
+{
+   CHECKa(r, 0.0);
+
+   return count_rec(r);
+}
+
+
+static double count_rec(ZDD r)
+{
+   BddCacheData *entry;
+   double res;
+
+   if (ISCONST(r))
+      return r;
+
+   entry = BddCache_lookup(&zddcache, COUNTHASH(r));
+   if (entry->a == r  &&  entry->c == ZCACHEID_COUNT)
+   {
+#ifdef CACHESTATS
+      bddcachestats.opHit++;
+#endif
+      return entry->r.dres;
+   }
+#ifdef CACHESTATS
+   bddcachestats.opMiss++;
+#endif
+
+   res = count_rec(LOW(r)) + count_rec(HIGH(r));
+
+   entry->a = r;
+   entry->c = ZCACHEID_COUNT;
+   entry->r.dres = res;
+
+   return res;
+}
+
+
+/*************************************************************************
+  Helpers
+*************************************************************************/
+
+   /* Build the table of the next level in 'r' at or below each level,
+      and optionally the polarity of each level in the cube 'r' */
+static int varset2leveltable(BDD r, int signed_set)
+{
+   BDD n;
+   int level;
+
+   if (r < 2)
+      return bdd_error(BDD_VARSET);
+
+   if (zddtablesize < bddvarnum+1)
+   {
+      free(zddnextlevel);
+      free(zddsign);
+      zddtablesize = bddvarnum+1;
+      zddnextlevel = NEW(int,zddtablesize);
+      zddsign = NEW(int,zddtablesize);
+      if (zddnextlevel == NULL  ||  zddsign == NULL)
+      {
+	 zddtablesize = 0;
+	 return bdd_error(BDD_MEMORY);
+      }
+   }
+
+   for (level=0 ; level<=bddvarnum ; level++)
+   {
+      zddnextlevel[level] = bddvarnum;
+      zddsign[level] = 0;
+   }
+
+   for (n=r ; !ISCONST(n) ; )
+   {
+      if (!signed_set  ||  ISZERO(LOW(n)))
+      {
+	 zddsign[LEVEL(n)] = 1;
+	 zddnextlevel[LEVEL(n)] = LEVEL(n);
+	 n = HIGH(n);
+      }
+      else
+      {
+	 zddsign[LEVEL(n)] = -1;
+	 zddnextlevel[LEVEL(n)] = LEVEL(n);
+	 n = LOW(n);
+      }
+   }
+
+   for (level=bddvarnum-1 ; level>=0 ; level--)
+      if (zddnextlevel[level] == bddvarnum)
+	 zddnextlevel[level] = zddnextlevel[level+1];
+
+   return 0;
+}
+
+
+/* EOF */
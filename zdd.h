@@ -0,0 +1,191 @@
+/*========================================================================
+               Copyright (C) 1996-2002 by Jorn Lind-Nielsen
+                            All rights reserved
+
+    Permission is hereby granted, without written agreement and without
+    license or royalty fees, to use, reproduce, prepare derivative
+    works, distribute, and display this software and its documentation
+    for any purpose, provided that (1) the above copyright notice and
+    the following two paragraphs appear in all copies of the source code
+    and (2) redistributions, including without limitation binaries,
+    reproduce these notices in the supporting documentation. Substantial
+    modifications to this software may be copyrighted by their authors
+    and need not follow the licensing terms described here, provided
+    that the new terms are clearly indicated in all files where they apply.
+
+    IN NO EVENT SHALL JORN LIND-NIELSEN, OR DISTRIBUTORS OF THIS
+    SOFTWARE BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL,
+    INCIDENTAL, OR CONSEQUENTIAL DAMAGES ARISING OUT OF THE USE OF THIS
+    SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE AUTHORS OR ANY OF THE
+    ABOVE PARTIES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    JORN LIND-NIELSEN SPECIFICALLY DISCLAIM ANY WARRANTIES, INCLUDING,
+    BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE. THE SOFTWARE PROVIDED HEREUNDER IS
+    ON AN "AS IS" BASIS, AND THE AUTHORS AND DISTRIBUTORS HAVE NO
+    OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR
+    MODIFICATIONS.
+========================================================================*/
+
+/*************************************************************************
+  FILE:  zdd.h
+  DESCR: Zero-suppressed decision diagrams on top of the BDD kernel
+*************************************************************************/
+
+#ifndef _ZDD_H
+#define _ZDD_H
+
+#include "bdd.h"
+
+/*=== User ZDD types ===================================================*/
+
+   /* A ZDD is a node in the shared BDD node table, read with the
+      zero-suppressed reduction rule. The constants 0 and 1 are the
+      empty family and the family holding only the empty set. */
+typedef int ZDD;
+
+#ifndef CPLUSPLUS
+typedef ZDD zdd;
+#endif /* CPLUSPLUS */
+
+
+#ifdef CPLUSPLUS
+extern "C" {
+#endif
+
+/* In file zdd.c */
+
+extern ZDD    zdd_union(ZDD, ZDD);
+extern ZDD    zdd_intersect(ZDD, ZDD);
+extern ZDD    zdd_diff(ZDD, ZDD);
+extern ZDD    zdd_exist(ZDD, BDD);
+extern ZDD    zdd_relprod(ZDD, ZDD, BDD);
+extern ZDD    zdd_restrict(ZDD, BDD);
+extern ZDD    zdd_replace(ZDD, bddPair*);
+extern ZDD    zdd_frombdd(BDD);
+extern BDD    zdd_tobdd(ZDD);
+extern double zdd_count(ZDD);
+
+#ifdef CPLUSPLUS
+}
+#endif
+
+
+/*************************************************************************
+   If this file is included from a C++ compiler then the following
+   classes, wrappers and hacks are supplied.
+*************************************************************************/
+#ifdef CPLUSPLUS
+
+/*=== ZDD class ========================================================*/
+
+class zdd
+{
+ public:
+
+   zdd(void)                  { root=0; }
+   zdd(const zdd &r)          { bdd_addref(root=r.root); }
+   ~zdd(void)                 { bdd_delref(root); }
+
+   int id(void) const         { return root; }
+
+   zdd operator=(const zdd &r)
+   {
+      if (root != r.root)
+      {
+	 bdd_delref(root);
+	 root = r.root;
+	 bdd_addref(root);
+      }
+      return *this;
+   }
+
+   zdd operator&(const zdd &r) const;
+   zdd operator&=(const zdd &r);
+   zdd operator|(const zdd &r) const;
+   zdd operator|=(const zdd &r);
+   zdd operator-(const zdd &r) const;
+   zdd operator-=(const zdd &r);
+   int operator==(const zdd &r) const { return root == r.root; }
+   int operator!=(const zdd &r) const { return root != r.root; }
+
+private:
+   ZDD root;
+
+   zdd(ZDD r) { bdd_addref(root=r); }
+
+   friend zdd    zdd_union(const zdd &, const zdd &);
+   friend zdd    zdd_intersect(const zdd &, const zdd &);
+   friend zdd    zdd_diff(const zdd &, const zdd &);
+   friend zdd    zdd_exist(const zdd &, const bdd &);
+   friend zdd    zdd_relprod(const zdd &, const zdd &, const bdd &);
+   friend zdd    zdd_restrict(const zdd &, const bdd &);
+   friend zdd    zdd_replace(const zdd &, bddPair*);
+   friend zdd    zdd_frombdd(const bdd &);
+   friend bdd    zdd_tobdd(const zdd &);
+   friend double zdd_count(const zdd &);
+   friend int    zdd_nodecount(const zdd &);
+};
+
+
+/*=== C++ interface ====================================================*/
+
+inline zdd zdd_union(const zdd &l, const zdd &r)
+{ return zdd_union(l.root, r.root); }
+
+inline zdd zdd_intersect(const zdd &l, const zdd &r)
+{ return zdd_intersect(l.root, r.root); }
+
+inline zdd zdd_diff(const zdd &l, const zdd &r)
+{ return zdd_diff(l.root, r.root); }
+
+inline zdd zdd_exist(const zdd &r, const bdd &var)
+{ return zdd_exist(r.root, var.root); }
+
+inline zdd zdd_relprod(const zdd &l, const zdd &r, const bdd &var)
+{ return zdd_relprod(l.root, r.root, var.root); }
+
+inline zdd zdd_restrict(const zdd &r, const bdd &var)
+{ return zdd_restrict(r.root, var.root); }
+
+inline zdd zdd_replace(const zdd &r, bddPair *p)
+{ return zdd_replace(r.root, p); }
+
+inline zdd zdd_frombdd(const bdd &r)
+{ return zdd_frombdd(r.root); }
+
+inline bdd zdd_tobdd(const zdd &r)
+{ return bdd(zdd_tobdd(r.root)); }
+
+inline double zdd_count(const zdd &r)
+{ return zdd_count(r.root); }
+
+   /* The node table is shared with the BDDs, so the BDD node
+      counter also works on ZDD roots */
+inline int zdd_nodecount(const zdd &r)
+{ return bdd_nodecount(r.root); }
+
+inline zdd zdd::operator&(const zdd &r) const
+{ return zdd_intersect(*this, r); }
+
+inline zdd zdd::operator&=(const zdd &r)
+{ return (*this = zdd_intersect(*this, r)); }
+
+inline zdd zdd::operator|(const zdd &r) const
+{ return zdd_union(*this, r); }
+
+inline zdd zdd::operator|=(const zdd &r)
+{ return (*this = zdd_union(*this, r)); }
+
+inline zdd zdd::operator-(const zdd &r) const
+{ return zdd_diff(*this, r); }
+
+inline zdd zdd::operator-=(const zdd &r)
+{ return (*this = zdd_diff(*this, r)); }
+
+#endif /* CPLUSPLUS */
+
+#endif /* _ZDD_H */
+
+
+/* EOF */